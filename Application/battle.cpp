@@ -0,0 +1,187 @@
+/*****************************************************************//**
+ * @file battle.cpp
+ *
+ * @brief implementation of the headless battle engine
+ *
+ ********************************************************************/
+
+#include "battle.h"
+
+BattleState::BattleState(const uint8_t *team_player, int n_player,
+      const uint8_t *team_cpu, int n_cpu) :
+      side { Party(team_player, n_player), Party(team_cpu, n_cpu) } {
+   turn = 0;
+   winner = NONE;
+}
+
+BattleState::~BattleState() {
+}  // not used
+
+void BattleState::reset() {
+   side[PLAYER].reset();
+   side[CPU].reset();
+   turn = 0;
+   winner = NONE;
+}
+
+int BattleState::over() const {
+   return (winner != NONE);
+}
+
+int BattleState::legal(int s, int act) const {
+   if (act >= 0 && act < N_MOVE_SLOTS)
+      return (1);
+   return (act >= ACT_SWITCH && act < N_ACTIONS && side[s].can_switch(act - ACT_SWITCH));
+}
+
+// cheap to copy for the ai search
+static_assert(sizeof(BattleState) <= 128, "BattleState grew beyond 128 bytes");
+
+namespace {
+
+void log_event(BattleLog &log, int type, int side, int arg, int value) {
+   BattleEvent *e;
+
+   if (log.n >= BattleLog::MAX_EVENTS)
+      return;
+   e = &log.ev[log.n++];
+   e->type = (uint8_t) type;
+   e->side = (uint8_t) side;
+   e->arg = (uint8_t) arg;
+   e->value = (int16_t) value;
+}
+
+// report the hp/stat changes of the active member of one side as events
+void log_changes(BattleLog &log, int s, const Party &before, const Party &after) {
+   int m = after.active;
+   int dh = after.hp[m] - before.hp[m];
+
+   if (dh < 0)
+      log_event(log, BEV_DAMAGE, s, 0, -dh);
+   else if (dh > 0)
+      log_event(log, BEV_HEAL, s, 0, dh);
+   if (after.atk_stage[m] > before.atk_stage[m])
+      log_event(log, BEV_STAT_UP, s, STAT_ATK, after.atk_stage[m]);
+   if (after.def_stage[m] > before.def_stage[m])
+      log_event(log, BEV_STAT_UP, s, STAT_DEF, after.def_stage[m]);
+   if (after.fainted(m) && !before.fainted(m))
+      log_event(log, BEV_FAINT, s, 0, 0);
+}
+
+void take_switch(BattleState &st, int user, int m, BattleLog &log) {
+   st.side[user].switch_to(m);
+   log_event(log, BEV_SWITCH, user, m, 0);
+}
+
+// one side uses a move; the rules live in apply_move(), events come from the diff
+void take_move(BattleState &st, int user, int slot, Prng &rng, BattleLog &log) {
+   int target = 1 - user;
+   Party &u = st.side[user];
+   Party &t = st.side[target];
+   int move, te;
+
+   if (st.over() || u.fainted(u.active) || t.fainted(t.active))
+      return;
+   move = u.move(u.active, slot);
+   const Party u0 = u;
+   const Party t0 = t;
+   log_event(log, BEV_MOVE, user, move, 0);
+   if (move_info(move).effect == EFF_DAMAGE) {
+      te = type_effect(move_info(move).type, t.species[t.active]);
+      if (te != TE_X1)
+         log_event(log, BEV_EFFECTIVE, user, move, te);
+   }
+   apply_move(u, move, t, rng);
+   log_changes(log, user, u0, u);
+   log_changes(log, target, t0, t);
+   if (t.healthy() == 0)
+      st.winner = (uint8_t) user;
+}
+
+// a fainted active member is replaced by the first healthy one
+void replace_fainted(BattleState &st, int s, BattleLog &log) {
+   Party &p = st.side[s];
+   int m;
+
+   if (st.over() || !p.fainted(p.active))
+      return;
+   for (m = 0; m < p.n; m++) {
+      if (p.can_switch(m)) {
+         take_switch(st, s, m, log);
+         return;
+      }
+   }
+}
+
+}  // namespace
+
+int battle_step(BattleState &st, int act_player, int act_cpu, Prng &rng,
+      BattleLog &log) {
+   int act[2], s, first, spd0, spd1;
+
+   log.n = 0;
+   act[BattleState::PLAYER] = act_player;
+   act[BattleState::CPU] = act_cpu;
+   for (s = 0; s < 2; s++) {
+      if (!st.legal(s, act[s]))
+         act[s] = 0;
+      if (act[s] >= ACT_SWITCH)
+         take_switch(st, s, act[s] - ACT_SWITCH, log);
+   }
+   // faster active member moves first
+   spd0 = st.side[0].speed(st.side[0].active);
+   spd1 = st.side[1].speed(st.side[1].active);
+   if (spd0 != spd1)
+      first = (spd1 > spd0) ? 1 : 0;
+   else
+      first = rng.below(2);
+   for (s = first; s < first + 2; s++) {
+      if (act[s & 1] < ACT_SWITCH)
+         take_move(st, s & 1, act[s & 1], rng, log);
+   }
+   replace_fainted(st, BattleState::PLAYER, log);
+   replace_fainted(st, BattleState::CPU, log);
+   st.turn++;
+   return (log.n);
+}
+
+int battle_check(const BattleState &st) {
+   int s, m, bad = 0;
+
+   for (s = 0; s < 2; s++) {
+      const Party &p = st.side[s];
+      if (p.n < 1 || p.n > Party::MAX_MEMBERS || p.active >= p.n) {
+         bad = bad | CHK_PARTY;
+         continue;
+      }
+      for (m = 0; m < p.n; m++) {
+         // max_hp() indexes the species table
+         if (p.species[m] >= N_SPECIES) {
+            bad = bad | CHK_SPECIES;
+            continue;
+         }
+         if (p.hp[m] < 0 || p.hp[m] > p.max_hp(m))
+            bad = bad | CHK_HP;
+         if ((p.hp[m] <= 0) != (p.fainted(m) != 0))
+            bad = bad | CHK_FAINT;
+         if (p.atk_stage[m] < -MAX_STAGE || p.atk_stage[m] > MAX_STAGE
+               || p.def_stage[m] < -MAX_STAGE || p.def_stage[m] > MAX_STAGE)
+            bad = bad | CHK_STAGE;
+      }
+      if (!st.over() && p.fainted(p.active))
+         bad = bad | CHK_ACTIVE;
+   }
+   if (st.winner != BattleState::PLAYER && st.winner != BattleState::CPU
+         && st.winner != BattleState::NONE)
+      return (bad | CHK_WINNER);
+   if (bad & CHK_PARTY)
+      return (bad);
+   // over exactly when a whole party fainted; the winner is the other side
+   if (st.side[0].healthy() == 0 || st.side[1].healthy() == 0) {
+      if (st.winner == BattleState::NONE || st.side[st.winner].healthy() == 0)
+         bad = bad | CHK_WINNER;
+   } else if (st.over()) {
+      bad = bad | CHK_WINNER;
+   }
+   return (bad);
+}
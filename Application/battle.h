@@ -0,0 +1,176 @@
+/*****************************************************************//**
+ * @file battle.h
+ *
+ * @brief headless battle engine
+ *
+ * Description:
+ *  - BattleState holds the complete state of one battle: two
+ *    parties in struct-of-arrays form, under 100 bytes, so the ai
+ *    search and snapshots copy it by value
+ *  - an action is a move slot of the active member or a switch to
+ *    another member (ACT_SWITCH + member)
+ *  - battle_step() plays one turn from the two chosen actions and
+ *    appends what happened to a compact event log
+ *  - no i/o, no timing and no global state: the same engine runs on
+ *    the board (with a presenter that animates the events) and on
+ *    the host
+ *  - all randomness comes from the Prng passed in, so a seed plus
+ *    the action sequence reproduces a battle exactly
+ *
+ *********************************************************************/
+
+#ifndef _BATTLE_H_INCLUDED
+#define _BATTLE_H_INCLUDED
+
+#include "pokedex.h"
+#include "prng.h"
+
+/**
+ * event types
+ */
+enum {
+   BEV_MOVE = 0,   /**< side used move arg */
+   BEV_DAMAGE,     /**< side lost value hp */
+   BEV_HEAL,       /**< side gained value hp */
+   BEV_STAT_UP,    /**< stat arg (STAT_xxx) of side raised to stage value */
+   BEV_FAINT,      /**< active member of side fainted */
+   BEV_SWITCH,     /**< side switched to member arg */
+   BEV_EFFECTIVE   /**< move of side was not neutral; value: quarters (TE_X1 = x1) */
+};
+
+/**
+ * actions
+ */
+enum {
+   ACT_SWITCH = N_MOVE_SLOTS,                  /**< + member: switch */
+   N_ACTIONS = N_MOVE_SLOTS + Party::MAX_MEMBERS
+};
+
+/**
+ * stats reported by BEV_STAT_UP
+ */
+enum {
+   STAT_ATK = 0,
+   STAT_DEF
+};
+
+/**
+ * invariant violations reported by battle_check()
+ */
+enum {
+   CHK_PARTY = 0x01,     /**< member count or active index out of range */
+   CHK_HP = 0x02,        /**< hp below 0 or above max hp */
+   CHK_FAINT = 0x04,     /**< fainted flag does not match hp == 0 */
+   CHK_STAGE = 0x08,     /**< stat stage beyond +/-MAX_STAGE */
+   CHK_ACTIVE = 0x10,    /**< fainted active member left in a running battle */
+   CHK_WINNER = 0x20,    /**< winner invalid or not matching the fainted parties */
+   CHK_SPECIES = 0x40    /**< species id out of range */
+};
+
+/**
+ * battle event
+ */
+struct BattleEvent {
+   uint8_t type;
+   uint8_t side;     // BattleState::PLAYER or CPU
+   uint8_t arg;
+   int16_t value;
+};
+
+/**
+ * events of one turn
+ */
+struct BattleLog {
+   enum {
+      MAX_EVENTS = 16   /**< worst case of one turn with room to spare */
+   };
+   BattleEvent ev[MAX_EVENTS];
+   int n;
+};
+
+/**
+ * battle state
+ */
+class BattleState {
+public:
+   /**
+    * sides
+    *
+    */
+   enum {
+      PLAYER = 0,
+      CPU = 1,
+      NONE = 0xff   /**< winner while the battle runs */
+   };
+
+   Party side[2];
+   uint16_t turn;
+   uint8_t winner;
+
+   /**
+    * constructor
+    *
+    * @param team_player species ids of the player's party
+    * @param n_player # player members
+    * @param team_cpu species ids of the cpu's party
+    * @param n_cpu # cpu members
+    *
+    */
+   BattleState(const uint8_t *team_player, int n_player,
+         const uint8_t *team_cpu, int n_cpu);
+   ~BattleState();  // not used
+
+   /**
+    * restart with full hp
+    *
+    */
+   void reset();
+
+   /**
+    * check whether the battle has ended
+    *
+    * @return 1: all members of a side fainted; 0: otherwise
+    *
+    */
+   int over() const;
+
+   /**
+    * check whether a side may take an action
+    *
+    * @param s side
+    * @param act action (move slot or ACT_SWITCH + member)
+    *
+    */
+   int legal(int s, int act) const;
+};
+
+/**
+ * play one turn
+ *
+ * @param st battle state (updated)
+ * @param act_player player action
+ * @param act_cpu cpu action
+ * @param rng random source for the turn's random rules
+ * @param log event log (cleared, then filled)
+ * @return # events
+ * @note switches come first, then moves in speed order (a tie is
+ *       decided by rng); a member
+ *       that fainted earlier in the turn does not act; at the end of
+ *       the turn a fainted active member is replaced by the first
+ *       healthy one; an illegal action uses move slot 0
+ *
+ */
+int battle_step(BattleState &st, int act_player, int act_cpu, Prng &rng,
+      BattleLog &log);
+
+/**
+ * check the invariants of a battle state
+ *
+ * @param st battle state
+ * @return 0: consistent; otherwise CHK_xxx bits of the violations
+ * @note meant for debug builds and host runs after battle_step()
+ *
+ */
+int battle_check(const BattleState &st);
+
+#endif  // _BATTLE_H_INCLUDED
@@ -0,0 +1,178 @@
+/*****************************************************************//**
+ * @file battle_ai.cpp
+ *
+ * @brief implementation of BattleAi class
+ *
+ ********************************************************************/
+
+#include "battle_ai.h"
+
+BattleAi::BattleAi(clock_fn clock) {
+   _clock = clock;
+   budget_us = DEF_BUDGET_US;
+   start_us = 0;
+   n_nodes = 0;
+   last_depth = 0;
+   aborted = 0;
+   for (int m = 0; m < Party::MAX_MEMBERS; m++)
+      recip[0][m] = recip[1][m] = 0;
+   scratch.n = 0;
+   tie = 0;
+   fixed_depth = 0;
+   cur_depth = 0;
+}
+
+BattleAi::~BattleAi() {
+}  // not used
+
+void BattleAi::set_budget(unsigned long us) {
+   budget_us = us;
+}
+
+void BattleAi::set_depth(int d) {
+   fixed_depth = (d > MAX_DEPTH) ? MAX_DEPTH : d;
+}
+
+void BattleAi::set_rng(Prng *r) {
+   tie = r;
+}
+
+int BattleAi::depth() {
+   return (last_depth);
+}
+
+unsigned long BattleAi::nodes() {
+   return (n_nodes);
+}
+
+// clock read only every CHECK_MASK+1 nodes (an MMIO read on the board)
+int BattleAi::timeout() {
+   if (aborted)
+      return (1);
+   if (fixed_depth > 0 || cur_depth == 1)
+      return (0);   // depth-limited search ignores the clock; depth 1 always completes
+   if ((n_nodes & CHECK_MASK) == 0 && (_clock() - start_us) >= budget_us)
+      aborted = 1;
+   return (aborted);
+}
+
+/*
+ * leaf value from the cpu side: difference of the party hp fraction
+ * sums (Q16) plus a small bonus per stat stage of the active members
+ */
+int32_t BattleAi::eval(const BattleState &st) {
+   const Party &pl = st.side[BattleState::PLAYER];
+   const Party &cpu = st.side[BattleState::CPU];
+   int32_t v = 0;
+   int m;
+
+   for (m = 0; m < Party::MAX_MEMBERS; m++) {
+      v = v + cpu.hp[m] * recip[BattleState::CPU][m];
+      v = v - pl.hp[m] * recip[BattleState::PLAYER][m];
+   }
+   v = v + ((int32_t) cpu.atk_stage[cpu.active] - (int32_t) pl.atk_stage[pl.active]) * 2048;
+   v = v + ((int32_t) cpu.def_stage[cpu.active] - (int32_t) pl.def_stage[pl.active]) * 1024;
+   return (v >> 4);
+}
+
+// chance node: the player's action is unknown; uniform weight
+// (rolls inside battle_step() are one sample from rng, not a branch;
+// the reseed gives siblings and deeper iterations the same rolls)
+int32_t BattleAi::cpu_move_value(const BattleState &st, int act, int depth) {
+   int32_t sum = 0;
+   int p, n = 0;
+
+   for (p = 0; p < N_ACTIONS; p++) {
+      if (!st.legal(BattleState::PLAYER, p))
+         continue;
+      BattleState next = st;
+      rng.seed(mix32(st.turn + 1));
+      battle_step(next, p, act, rng, scratch);
+      sum = sum + value(next, depth - 1);
+      n++;
+      if (aborted)
+         return (0);
+   }
+   return (sum / n);
+}
+
+// max node; quicker wins (more depth left) score higher
+int32_t BattleAi::value(const BattleState &st, int depth) {
+   int32_t best, v;
+   int a;
+
+   n_nodes++;
+   if (st.over())
+      return ((st.winner == BattleState::CPU) ? (WIN_SCORE + depth) : -(WIN_SCORE + depth));
+   if (depth == 0 || timeout())
+      return (eval(st));
+   best = -(WIN_SCORE << 1);
+   for (a = 0; a < N_ACTIONS; a++) {
+      if (!st.legal(BattleState::CPU, a))
+         continue;
+      v = cpu_move_value(st, a, depth);
+      if (aborted)
+         return (0);
+      if (v > best)
+         best = v;
+   }
+   return (best);
+}
+
+/*
+ * iterative deepening; the tie break draws only after the search so
+ * the generator advances the same way whatever depth the clock allowed
+ */
+int BattleAi::choose(const BattleState &st) {
+   int d, a, n, s, m, max_d;
+   uint32_t mask, best_mask;
+   int32_t v, best_v;
+
+   start_us = _clock();
+   n_nodes = 0;
+   aborted = 0;
+   last_depth = 0;
+   // reciprocals once per search; no division at the leaves
+   for (s = 0; s < 2; s++)
+      for (m = 0; m < Party::MAX_MEMBERS; m++)
+         recip[s][m] = (m < st.side[s].n) ? (int32_t) (65536 / st.side[s].max_hp(m)) : 0;
+   max_d = (fixed_depth > 0) ? fixed_depth : MAX_DEPTH;
+   best_mask = 1;
+   for (d = 1; d <= max_d; d++) {
+      cur_depth = d;
+      mask = 0;
+      best_v = -(WIN_SCORE << 1);
+      for (a = 0; a < N_ACTIONS; a++) {
+         if (!st.legal(BattleState::CPU, a))
+            continue;
+         v = cpu_move_value(st, a, d);
+         if (aborted)
+            break;
+         if (v > best_v) {
+            best_v = v;
+            mask = 1 << a;
+         } else if (v == best_v) {
+            mask = mask | (1 << a);
+         }
+      }
+      if (aborted)
+         break;   // keep the answer of the last full depth
+      best_mask = mask;
+      last_depth = d;
+      // a forced win/loss does not change with more depth
+      if (best_v >= WIN_SCORE || best_v <= -WIN_SCORE)
+         break;
+   }
+   // pick among the equally good moves
+   for (a = 0, n = 0; a < N_ACTIONS; a++)
+      n = n + ((best_mask >> a) & 1);
+   n = (tie && n > 1) ? tie->below(n) : 0;
+   for (a = 0; a < N_ACTIONS; a++) {
+      if ((best_mask >> a) & 1) {
+         if (n == 0)
+            return (a);
+         n--;
+      }
+   }
+   return (0);
+}
@@ -0,0 +1,130 @@
+/*****************************************************************//**
+ * @file battle_ai.h
+ *
+ * @brief cpu opponent: expectimax search within a time budget
+ *
+ * Description:
+ *  - searches the headless engine (battle_step()) on copies of the
+ *    BattleState; no heap, one scratch event log, state copies of a
+ *    few dozen bytes on the stack per ply
+ *  - each ply: the cpu picks the action (move or switch) with the
+ *    best value (max node); the player's simultaneous choice is
+ *    unknown, so it is a chance node weighted uniformly over the
+ *    player's legal actions
+ *  - damage rolls and speed ties are sampled, not averaged: the
+ *    generator is reseeded from the turn number before each searched
+ *    turn, so all actions at one ply and every deepening iteration
+ *    see the same rolls and are compared against one fixed sequence
+ *    (branching over rolls would multiply the nodes per ply and cost
+ *    about one depth level within the same budget)
+ *  - iterative deepening: depth 1, 2, ... until the time budget runs
+ *    out; an unfinished depth is discarded, so the answer always
+ *    comes from the deepest completed search (depth 1 always
+ *    completes; at most 100 engine turns)
+ *  - the clock is a function pointer (now_us() on the board; any
+ *    microsecond clock on the host)
+ *  - equally good moves are picked at random from an optional
+ *    generator (set_rng()); without one the first is taken
+ *
+ *********************************************************************/
+
+#ifndef _BATTLE_AI_H_INCLUDED
+#define _BATTLE_AI_H_INCLUDED
+
+#include "battle.h"
+
+/**
+ * expectimax opponent
+ *
+ */
+class BattleAi {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      DEF_BUDGET_US = 50000,   /**< default search time per turn */
+      MAX_DEPTH = 8,           /**< max # turns searched */
+      CHECK_MASK = 15,         /**< read the clock every 16 nodes */
+      WIN_SCORE = 1 << 20      /**< value of a won battle */
+   };
+   typedef unsigned long (*clock_fn)();
+
+   /**
+    * constructor
+    *
+    * @param clock microsecond clock
+    *
+    */
+   BattleAi(clock_fn clock);
+   ~BattleAi();  // not used
+
+   /**
+    * set search time per turn
+    *
+    * @param us time budget in microseconds
+    *
+    */
+   void set_budget(unsigned long us);
+
+   /**
+    * search to a fixed depth regardless of time (e.g., for replays)
+    *
+    * @param d depth (1 to MAX_DEPTH); 0: time budget decides
+    * @note gives the same choice as a timed search that completed
+    *       depth d
+    *
+    */
+   void set_depth(int d);
+
+   /**
+    * set generator for tie breaks
+    *
+    * @param r pointer to generator (0: no random tie break)
+    *
+    */
+   void set_rng(Prng *r);
+
+   /**
+    * choose the cpu action
+    *
+    * @param st current battle state (not changed)
+    * @return cpu action (move slot or ACT_SWITCH + member)
+    *
+    */
+   int choose(const BattleState &st);
+
+   /**
+    * depth of the last completed search
+    *
+    */
+   int depth();
+
+   /**
+    * # nodes visited by the last choose()
+    *
+    */
+   unsigned long nodes();
+
+private:
+   clock_fn _clock;
+   unsigned long budget_us;
+   unsigned long start_us;
+   unsigned long n_nodes;
+   int last_depth;
+   int fixed_depth;     // 0: limited by budget_us
+   int cur_depth;       // depth being searched
+   int aborted;
+   int32_t recip[2][Party::MAX_MEMBERS];   // 2^16/max hp of each member
+   BattleLog scratch;   // events of searched turns (discarded)
+   Prng rng;            // random source of searched turns (reseeded per turn)
+   Prng *tie;           // random source of tie breaks
+   /* methods */
+   int32_t value(const BattleState &st, int depth);
+   int32_t cpu_move_value(const BattleState &st, int act, int depth);
+   int32_t eval(const BattleState &st);
+   int timeout();
+};
+
+#endif  // _BATTLE_AI_H_INCLUDED
@@ -0,0 +1,28 @@
+/*****************************************************************//**
+ * @file boot_seed.cpp
+ *
+ * @brief implementation of boot_seed()
+ *
+ ********************************************************************/
+
+#include "boot_seed.h"
+#include "prng.h"
+
+uint32_t boot_seed(XadcCore *adc, int rounds) {
+   uint32_t h, raw, spins;
+   unsigned long t0;
+   int i;
+
+   h = 0;
+   for (i = 0; i < rounds; i++) {
+      // alternate temperature and vcc; noise sits in the low bits
+      raw = adc->read_raw(XadcCore::TMP_REG + (i & 1));
+      // let the xadc convert again; # polls depends on bus/timer phase
+      t0 = now_us();
+      spins = 0;
+      while ((now_us() - t0) < 8)
+         spins++;
+      h = mix32(h ^ raw ^ (spins << 16) ^ ((uint32_t) t0 << 24));
+   }
+   return (h);
+}
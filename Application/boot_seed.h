@@ -0,0 +1,31 @@
+/*****************************************************************//**
+ * @file boot_seed.h
+ *
+ * @brief collect a random seed at power-on
+ *
+ * Description:
+ *  - the low bits of the xadc temperature/vcc readings are noisy
+ *  - the number of timer ticks spent polling varies with the
+ *    conversion timing of the xadc
+ *  - both are folded into a 32-bit seed with an avalanche mix
+ *
+ *********************************************************************/
+
+#ifndef _BOOT_SEED_H_INCLUDED
+#define _BOOT_SEED_H_INCLUDED
+
+#include "chu_init.h"
+#include "xadc_core.h"
+
+/**
+ * collect a seed from xadc noise and timer jitter
+ *
+ * @param adc pointer to xadc core instance
+ * @param rounds # readings folded in (e.g., 64)
+ * @return seed
+ * @note takes about rounds * 8 us
+ *
+ */
+uint32_t boot_seed(XadcCore *adc, int rounds);
+
+#endif  // _BOOT_SEED_H_INCLUDED
@@ -0,0 +1,145 @@
+/*****************************************************************//**
+ * @file input.cpp
+ *
+ * @brief implementation of InputService class
+ *
+ ********************************************************************/
+
+#include "input.h"
+#include "replay.h"
+
+InputService::InputService(DebounceCore *btn, GpiCore *sw, Ps2Core *ps2) {
+   _btn = btn;
+   _sw = sw;
+   _ps2 = ps2;
+   tick_ms = DEF_TICK_MS;
+   last_ms = 0;
+   btn_prev = 0;
+   sw_prev = 0;
+   head = 0;
+   tail = 0;
+   n_drop = 0;
+   _log = 0;
+   pend_ok = 0;
+}
+
+InputService::~InputService() {
+}  // not used
+
+void InputService::init() {
+   if (_btn)
+      btn_prev = _btn->read_db();
+   if (_sw)
+      sw_prev = _sw->read();
+   flush();
+   n_drop = 0;
+   last_ms = now_ms();
+}
+
+void InputService::set_log(ReplayLog *log) {
+   _log = log;
+   pend_ok = 0;
+}
+
+void InputService::set_tick(int ms) {
+   tick_ms = (ms > 0) ? ms : DEF_TICK_MS;
+}
+
+uint32_t InputService::buttons() {
+   return (btn_prev);
+}
+
+uint32_t InputService::switches() {
+   return (sw_prev);
+}
+
+unsigned long InputService::dropped() {
+   return (n_drop);
+}
+
+void InputService::update() {
+   unsigned long now;
+   uint32_t cur;
+   char ch;
+   int n;
+
+   now = now_ms();
+   if ((now - last_ms) < tick_ms)
+      return;
+   last_ms = now;
+   // one read per register for all bits
+   if (_btn) {
+      cur = _btn->read_db();
+      push_edges(EV_BTN, cur, btn_prev, now);
+      btn_prev = cur;
+   }
+   if (_sw) {
+      cur = _sw->read();
+      push_edges(EV_SW, cur, sw_prev, now);
+      sw_prev = cur;
+   }
+   if (_ps2) {
+      for (n = 0; n < MAX_KEYS && _ps2->get_kb_ch(&ch); n++)
+         push_at(now, EV_KEY, (uint8_t) ch, 1);
+   }
+}
+
+// changed = cur ^ prev; bits pushed from lsb up
+void InputService::push_edges(int type, uint32_t cur, uint32_t prev, uint32_t t) {
+   uint32_t changed;
+   int i;
+
+   changed = cur ^ prev;
+   for (i = 0; changed != 0; i++, changed >>= 1, cur >>= 1) {
+      if (changed & 0x01)
+         push_at(t, type, i, (int) (cur & 0x01));
+   }
+}
+
+int InputService::push(int type, int code, int value) {
+   return (push_at((uint32_t) now_ms(), type, code, value));
+}
+
+int InputService::push_at(uint32_t t, int type, int code, int value) {
+   int next;
+
+   if (_log && _log->mode() == ReplayLog::MODE_REPLAY)
+      return (0);   // live input ignored during a replay
+   next = (tail + 1) & (Q_LEN - 1);
+   if (next == head) {
+      n_drop++;
+      return (-1);
+   }
+   q[tail].ms = t;
+   q[tail].type = (uint8_t) type;
+   q[tail].code = (uint8_t) code;
+   q[tail].value = (uint8_t) value;
+   tail = next;
+   return (0);
+}
+
+int InputService::pop(InputEvent *ev) {
+   if (_log && _log->mode() == ReplayLog::MODE_REPLAY) {
+      if (!pend_ok)
+         pend_ok = _log->get_input(&pend);
+      if (pend_ok) {
+         if ((long) (now_ms() - pend.ms) < 0)
+            return (0);
+         *ev = pend;
+         pend_ok = 0;
+         return (1);
+      }
+      // log ended: back to live input
+   }
+   if (head == tail)
+      return (0);
+   *ev = q[head];
+   head = (head + 1) & (Q_LEN - 1);
+   if (_log)
+      _log->put_input(*ev);
+   return (1);
+}
+
+void InputService::flush() {
+   head = tail;
+}
@@ -0,0 +1,187 @@
+/*****************************************************************//**
+ * @file input.h
+ *
+ * @brief input service: edge events from buttons, switches and keyboard
+ *
+ * Description:
+ *  - update() is a periodic task; each tick reads the debounced
+ *    button register and the switch register once (one MMIO read
+ *    each for all bits)
+ *  - edges are found with a single XOR against the previous word;
+ *    each changed bit becomes one event (value 1: pressed/up;
+ *    0: released/down)
+ *  - ps2 keyboard characters and other sources (e.g., taps via
+ *    push()) share the same timestamped FIFO queue, so the game
+ *    reads all controls from one place
+ *  - with a ReplayLog attached, pop() records each event the game
+ *    consumes, or, while replaying, returns the logged events at
+ *    their recorded times instead of live input
+ *
+ *********************************************************************/
+
+#ifndef _INPUT_H_INCLUDED
+#define _INPUT_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+#include "ps2_core.h"
+
+class ReplayLog;
+
+/**
+ * input event
+ *  - code: ascii/special code (EV_KEY), bit number (EV_BTN/EV_SW)
+ *
+ */
+struct InputEvent {
+   uint32_t ms;      // timestamp (now_ms()) of the tick that saw it
+   uint8_t type;     // InputService::EV_xxx
+   uint8_t code;
+   uint8_t value;
+};
+
+/**
+ * input service
+ *
+ */
+class InputService {
+public:
+   /**
+    * event types
+    *
+    */
+   enum {
+      EV_KEY = 0,   /**< ps2 keyboard character (value always 1) */
+      EV_BTN,       /**< push button edge */
+      EV_SW,        /**< slide switch edge */
+      EV_TAP,       /**< accelerometer tap (pushed by the application) */
+      N_EV_TYPES
+   };
+   /**
+    * button bits (Nexys4 DDR debounce core)
+    *
+    */
+   enum {
+      BTN_UP = 0,
+      BTN_RIGHT = 1,
+      BTN_DOWN = 2,
+      BTN_LEFT = 3,
+      BTN_CENTER = 4
+   };
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      Q_LEN = 32,        /**< # queue entries (power of 2) */
+      DEF_TICK_MS = 5,   /**< default sampling tick in ms */
+      MAX_KEYS = 4       /**< max # keyboard characters read per tick */
+   };
+
+   /**
+    * constructor
+    *
+    * @param btn pointer to button debounce core (may be 0)
+    * @param sw pointer to switch gpi core (may be 0)
+    * @param ps2 pointer to ps2 core with a keyboard (may be 0)
+    *
+    */
+   InputService(DebounceCore *btn, GpiCore *sw, Ps2Core *ps2);
+   ~InputService();  // not used
+
+   /**
+    * attach a session log
+    *
+    * @param log pointer to log (0: none)
+    *
+    */
+   void set_log(ReplayLog *log);
+
+   /**
+    * latch current levels as the baseline and empty the queue
+    *
+    * @note levels already held at init() produce no events
+    *
+    */
+   void init();
+
+   /**
+    * set sampling tick
+    *
+    * @param ms tick in ms
+    *
+    */
+   void set_tick(int ms);
+
+   /**
+    * periodic task; sample all sources when the tick elapses
+    *
+    */
+   void update();
+
+   /**
+    * append an event from another source
+    *
+    * @param type event type
+    * @param code event code
+    * @param value event value
+    * @return 0: ok; -1: queue full (event dropped)
+    *
+    */
+   int push(int type, int code, int value);
+
+   /**
+    * remove the oldest event
+    *
+    * @param ev pointer to the event returned
+    * @return 1: event returned; 0: queue empty
+    * @note while replaying, live events are dropped and the logged
+    *       ones are returned once their time has come
+    *
+    */
+   int pop(InputEvent *ev);
+
+   /**
+    * discard all queued events
+    *
+    */
+   void flush();
+
+   /**
+    * debounced button levels at the last tick
+    *
+    */
+   uint32_t buttons();
+
+   /**
+    * switch levels at the last tick
+    *
+    */
+   uint32_t switches();
+
+   /**
+    * # events dropped because the queue was full
+    *
+    */
+   unsigned long dropped();
+
+private:
+   DebounceCore *_btn;
+   GpiCore *_sw;
+   Ps2Core *_ps2;
+   uint32_t btn_prev, sw_prev;
+   unsigned long tick_ms, last_ms;
+   /* event FIFO */
+   InputEvent q[Q_LEN];
+   int head, tail;
+   unsigned long n_drop;
+   /* session log */
+   ReplayLog *_log;
+   InputEvent pend;     // next logged event (replay)
+   int pend_ok;
+   /* methods */
+   int push_at(uint32_t t, int type, int code, int value);
+   void push_edges(int type, uint32_t cur, uint32_t prev, uint32_t t);
+};
+
+#endif  // _INPUT_H_INCLUDED
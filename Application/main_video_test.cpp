@@ -14,8 +14,24 @@
 #include "sseg_core.h"
 #include "ps2_core.h"
 #include "spi_core.h"
-#include <cstring>
-#include <cmath>
+#include "tap_detect.h"
+#include "input.h"
+#include "pokedex.h"
+#include "battle.h"
+#include "battle_ai.h"
+#include "prng.h"
+#include "boot_seed.h"
+#include "replay.h"
+#include "xadc_core.h"
+#include "i2c_core.h"
+#include "adt7420.h"
+#include "ddfs_core.h"
+#include "adsr_core.h"
+#include "sequencer.h"
+#include "pcm_capture.h"
+#include "mixer.h"
+#include "osd_shadow.h"
+#include "scene.h"
 
 
 void test_start(GpoCore *led_p) {
@@ -142,12 +158,7 @@ void ghost_check(SpriteCore *ghost_p) {
    sleep_ms(3000);
 }
 
-void start_screen(FrameCore *frame_p, OsdCore *osd_p){
-	frame_p->bypass(0);
-	frame_p->clr_screen(0x0000);
-	osd_p->set_color(0x0ff, 0x111);
-	osd_p->bypass(0);
-	osd_p->clr_screen();
+void start_screen(OsdShadow *osd_p){
 	char text[] = {' ',' ','F','P','G','A',' ','P','O','K','E','M','O','N',' ',' '};
 	char start[] = {'A','N','Y',' ','K','E','Y',' ','T','O',' ','S','T','A','R','T'};
 	for(int i = 0; i < 16; i++){
@@ -156,18 +167,7 @@ void start_screen(FrameCore *frame_p, OsdCore *osd_p){
 	}
 }
 
-void start_key(Ps2Core *ps2_p){
-	char ch;
-	while(!ps2_p->get_kb_ch(&ch)){
-
-	}
-	return;
-}
-
-void game_over(FrameCore *frame_p, OsdCore *osd_p){
-	frame_p->clr_screen(0x00);
-	osd_p->set_color(0xf00, 0x000);
-	osd_p->clr_screen();
+void game_over(OsdShadow *osd_p){
 	char gameOver[] = {'G','A','M','E',' ','O','V','E','R'};
 	for(int i = 0; i < 9; i++){
 		osd_p->wr_char(i + 38, 10, gameOver[i]);
@@ -189,139 +189,178 @@ SpriteCore mewtwo(get_sprite_addr(BRIDGE_BASE, V3_GHOST), 1024);
 SpriteCore snorlax(get_sprite_addr(BRIDGE_BASE, V1_MOUSE), 1024);
 SpriteCore cursor(get_sprite_addr(BRIDGE_BASE, V4_USER4), 1024);
 OsdCore osd(get_sprite_addr(BRIDGE_BASE, V2_OSD));
+OsdShadow osd_buf(&osd);
 SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
 Ps2Core ps2(get_slot_addr(BRIDGE_BASE, S11_PS2));
 SpiCore spi(get_slot_addr(BRIDGE_BASE, S9_SPI));
+TapDetector tap(&spi);
+I2cCore i2c(get_slot_addr(BRIDGE_BASE, S10_I2C));
+Adt7420 thermo(&i2c);
+DdfsCore ddfs(get_slot_addr(BRIDGE_BASE, S12_DDFS));
+AdsrCore adsr(get_slot_addr(BRIDGE_BASE, S13_ADSR), &ddfs);
+Sequencer seq(&adsr);
+PcmCapture pcm(&ddfs, &uart);
+PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+Mixer mix(&pwm, Mixer::DEF_CH);
+DebounceCore btn(get_slot_addr(BRIDGE_BASE, S7_BTN));
+InputService input(&btn, &sw, &ps2);
+XadcCore adc(get_slot_addr(BRIDGE_BASE, S5_XDAC));
+RngService rng;
+ReplayLog replay;
+
+// battle music: bass line (A) and arpeggio (B); order A A B A
+const SeqNote BATTLE_A[] = {
+   {9, 2, 2, 2}, {9, 3, 2, 2}, {9, 2, 2, 2}, {7, 3, 2, 2},
+   {5, 2, 2, 2}, {5, 3, 2, 2}, {7, 2, 2, 2}, {8, 3, 2, 2},
+   {Sequencer::END, 0, 0, 0}
+};
+const SeqNote BATTLE_B[] = {
+   {9, 3, 1, 2}, {0, 4, 1, 2}, {4, 4, 1, 2}, {9, 4, 1, 2},
+   {4, 4, 1, 2}, {0, 4, 1, 2}, {Sequencer::REST, 0, 2, 2},
+   {5, 3, 1, 2}, {9, 3, 1, 2}, {0, 4, 1, 2}, {5, 4, 1, 2},
+   {7, 3, 2, 2}, {11, 3, 2, 2},
+   {Sequencer::END, 0, 0, 0}
+};
+const SeqNote *const BATTLE_PATTERNS[] = { BATTLE_A, BATTLE_B };
+const uint8_t BATTLE_ORDER[] = { 0, 0, 1, 0 };
 
-void environmentInit(FrameCore *frame_p) {
-    //background
-    frame.clr_screen(0xfff);
+// move sound effects
+const SeqNote SFX_HIT[] = {
+   {7, 5, 1, 0}, {2, 5, 1, 0}, {7, 4, 1, 0}, {2, 4, 2, 0},
+   {Sequencer::END, 0, 0, 0}
+};
+const SeqNote SFX_HEAL[] = {
+   {0, 5, 1, 1}, {4, 5, 1, 1}, {7, 5, 1, 1}, {0, 6, 2, 1},
+   {Sequencer::END, 0, 0, 0}
+};
 
-    //player platform
-    frame_p->fillRoundRect(-50, 300, 400, 150, 600, 0x092);
-    frame_p->fillRoundRect(-40, 305, 380, 140, 200, 0x0db);
-    frame_p->fillRoundRect(-30, 315, 360, 120, 200, 0x16d);
+/**
+ * hit effect: ddfs jingle layered with a mixer thump (pmod ja)
+ */
+void sfx_hit() {
+   seq.play_sfx(SFX_HIT);
+   // pitch varies per hit; fx stream does not disturb battle rolls
+   mix.play(38 + rng.stream(RngService::RNG_FX).below(5), Mixer::WAVE_SAW, 255, 120);
+   mix.play(28, Mixer::WAVE_SQUARE, 160, 200);
+}
 
-    //cpu platform
-    frame_p->fillRoundRect(330, 130, 300, 90, 600, 0x092); //416, 47 center
-    frame_p->fillRoundRect(340, 135, 280, 80, 200, 0x0db);
-    frame_p->fillRoundRect(350, 140, 260, 70, 200, 0x16d);
+/**
+ * run background tasks (input, sensor sampling, music, mixer, 7-seg)
+ */
+void service_tasks() {
+   input.update();
+   if (tap.poll())
+      input.push(InputService::EV_TAP, 0, 1);
+   thermo.update();
+   seq.update();
+   pcm.update();
+   mix.update();
+   sseg.update();
+}
 
-    //bottom text
-    frame_p->fillRect(0, 380, 640, 100, 0x000);
-    frame_p->fillRoundRect(10, 385, 620, 95, 20, 0xfff);
+/**
+ * check for a key or button press (queued events are consumed)
+ * @return 1: pressed; 0: no press queued
+ */
+int pressed() {
+   InputEvent ev;
 
-    //player status
-    frame_p->fillRoundRect(400, 240, 240, 140, 20, 0x000);
-    frame_p->fillRoundRect(405, 245, 230, 130, 20, 0xfff);
+   while (input.pop(&ev)) {
+      if (ev.type == InputService::EV_KEY
+            || (ev.type == InputService::EV_BTN && ev.value))
+         return (1);
+   }
+   return (0);
+}
 
-    //cpu status
-    frame_p->fillRoundRect(3, 40, 240, 80, 20, 0x000);
-    frame_p->fillRoundRect(8, 45, 230, 70, 20, 0xfff);
+/**
+ * clock of the ai search; background tasks keep running while it thinks
+ */
+unsigned long ai_clock() {
+   service_tasks();
+   return (now_us());
 }
 
-class Move{
-public:
-	char Name[20];
-	int damage;
-	bool nonAtk = false;
-	//constructor
-	Move(const char* name, int damage, bool nonAtk) : damage(damage), nonAtk(nonAtk) {
-		strncpy(Name, name, sizeof(Name) - 1);
-		Name[sizeof(Name) - 1] = '\0';
-	}
-};
+BattleAi ai(ai_clock);
 
-class Pokemon{
-public:
-    char Name[8];
-    int speed, def, attack, level, health;
-    int maxHP;
-    bool isFainted = false;
-    Move moves[4];
-
-    // Constructor
-    Pokemon(const char* name, int spd, int def, int att, int lvl, int h, const Move& move1, const Move& move2, const Move& move3, const Move& move4):
-    	speed(spd), def(def), attack(att), level(lvl), health(h), moves{move1,move2,move3,move4} {
-//    	moves[0] = move1;
-//    	moves[1] = move2;
-//    	moves[2] = move3;
-//    	moves[3] = move4;
-		strncpy(Name, name, sizeof(Name) - 1);
-		Name[sizeof(Name) - 1] = '\0';
-		maxHP = h;
-    }
-
-    void makeMove(Pokemon& attackingPokemon, const Move& move, Pokemon& attackedPokemon){
-    	if(move.nonAtk == false){
-    		attackedPokemon.health = attackedPokemon.health - move.damage;
-    		if(health < 0) health = 0;
-    	}
-    	else if(strcmp(move.Name, "Recover") == 0){
-    		int recoveredHealth = floor(attackingPokemon.health/2);
-    		attackingPokemon.health = attackingPokemon.health + recoveredHealth;
-    		if(attackingPokemon.health > attackingPokemon.maxHP)
-    			attackingPokemon.health = attackingPokemon.maxHP;
-    	}
-    	else if(strcmp(move.Name, "Rest") == 0){
-    		attackingPokemon.health = attackingPokemon.maxHP;
-    	}
-    	else if(strcmp(move.Name, "Amnesia")){
-    		attackingPokemon.def = attackingPokemon.def * 2;
-    	}
-    }
+/**
+ * cpu action; a replay repeats the recorded search depths
+ * @param st current battle state
+ * @return cpu action (move slot or ACT_SWITCH + member)
+ */
+int cpu_move(const BattleState &st) {
+   int a;
+
+   if (replay.mode() == ReplayLog::MODE_REPLAY)
+      ai.set_depth(replay.get_ai());
+   a = ai.choose(st);
+   replay.put_ai(ai.depth());
+   ai.set_depth(0);
+   return (a);
+}
 
-};
+/**
+ * check for the switch menu toggle: 's' key or center button
+ */
+int event_switch(const InputEvent &ev) {
+   if (ev.type == InputService::EV_KEY)
+      return (ev.code == 's' || ev.code == 'S');
+   return (ev.type == InputService::EV_BTN && ev.value && ev.code == InputService::BTN_CENTER);
+}
 
-	bool isOneToFour(char c){
-		if(c >= 0x31 && c <= 0x34)
-			return true;
-		else
-			return false;
-	}
+/**
+ * map an input event to a menu choice
+ * @param ev input event
+ * @param n # choices (keys '1' to '0'+n)
+ * @return 1 to n: number keys or buttons up/right/down/left (1-4); 0: none
+ */
+int event_choice(const InputEvent &ev, int n) {
+   if (ev.type == InputService::EV_KEY && ev.code >= '1' && ev.code <= '0' + n)
+      return (ev.code - '0');
+   if (ev.type == InputService::EV_BTN && ev.value && ev.code <= InputService::BTN_LEFT)
+      return (ev.code + 1);
+   return (0);
+}
 
-	char asciiToDigit(char c){
-		c = c - 0x30;
-		return c;
+	void fainted(OsdShadow *osd_p, const Party& party){
+		int n = osd_p->wr_str(5, 24, party.name(party.active));
+		osd_p->wr_str(n, 24, " has fainted");
 	}
 
-	void fainted(OsdCore *osd_p, Pokemon& pokemon){
-		char fainted[] = {'h','a','s',' ','f','a','i','n','t','e','d'};
-		for(int i = 0; i < 8; i++){
-		osd_p->wr_char(i + 5, 24, pokemon.Name[i]);
-		osd_p->wr_char(i + 5, 24, fainted[i]);
+	/**
+	 * write a name padded with transparent tiles to a fixed width
+	 */
+	void name_field(OsdShadow *osd, int x, int y, const char *name, int width){
+		for(int i = 0; i < width; i++){
+			osd->wr_char(x + i, y, *name);
+			if(*name != 0)
+				name++;
 		}
 	}
 
-	void hpBar(OsdCore * osd, Pokemon &poke1, Pokemon &poke2){
-	    int healthHundreths = poke1.health / 100;
-	    int healthTens = (poke1.health % 100) / 10;
-	    int healthOnes = poke1.health % 10;
-
-	    char HPValue1[] = {healthHundreths+48, healthTens+48, healthOnes+48, '/', '5', '2', '3'};
-	    for(int i = 0; i < 7; i++){
-	        osd->wr_char(i + 54, 19, HPValue1[i]);
-	    }
-
-	    healthHundreths = poke2.health / 100;
-	    healthTens = (poke2.health % 100) / 10;
-	    healthOnes = poke2.health % 10;
-
-	    char HPValue2[] = {healthHundreths+48, healthTens+48, healthOnes+48, '/', '4', '1', '5'};
-	        for(int i = 0; i < 7; i++){
-	            osd->wr_char(i + 5, 5, HPValue2[i]);
-	        }
+	/**
+	 * write hp/max hp of the active member as "hhh/mmm"
+	 */
+	void hp_text(OsdShadow *osd, int x, int y, const Party &p){
+		int hp = p.hp[p.active];
+		int max = p.max_hp(p.active);
+		char s[] = {(char) ('0' + hp / 100), (char) ('0' + hp / 10 % 10), (char) ('0' + hp % 10), '/',
+		            (char) ('0' + max / 100), (char) ('0' + max / 10 % 10), (char) ('0' + max % 10), 0};
+		osd->wr_str(x, y, s);
 	}
 
-	void show_status(FrameCore *frame, OsdCore *osd, Pokemon *Snorlax, Pokemon *Mewtwo){
+	void hpBar(OsdShadow *osd, const Party &party1, const Party &party2){
+	    hp_text(osd, 54, 19, party1);
+	    hp_text(osd, 5, 5, party2);
+	    // scoreboard: player hp on left 4 digits, cpu hp on right 4 digits
+	    sseg.show_dec(party1.hp[party1.active], 4, 4);
+	    sseg.show_dec(party2.hp[party2.active], 0, 4);
+	}
 
-	    char playerName[] = {'S', 'N', 'O', 'R', 'L', 'A', 'X'};
-	    for(int i = 0; i < 7; i++) {osd->wr_char(i + 51, 16, playerName[i]);}
-	    char gender[] = {11};
-	    osd->wr_char(58, 16, gender[0]);
+	void show_status(OsdShadow *osd, const Party *player, const Party *cpu){
 
-	    char cpuName[] = {'M', 'E', 'W', 'T', 'W', 'O'};
-	    for(int i = 0; i < 6; i++) {osd->wr_char(i + 2, 3, cpuName[i]);}
+	    name_field(osd, 51, 16, player->name(player->active), 10);
+	    name_field(osd, 2, 3, cpu->name(cpu->active), 10);
 
 	    char lvl[] = {'L', 'v', ':', '1', '0', '0'};
 	    for(int i = 0; i < 6; i++) {osd->wr_char(i + 73, 16, lvl[i]);}
@@ -331,258 +370,16 @@ public:
 	    for(int i = 0; i < 2; i++) {osd->wr_char(i + 51, 19, HP[i]);}
 	    for(int i = 0; i < 2; i++) {osd->wr_char(i + 2, 5, HP[i]);}
 
-	    hpBar(osd, *Snorlax, *Mewtwo);
+	    // party: one ball per member, 'x' when fainted
+	    for(int m = 0; m < player->n; m++) {osd->wr_char(m + 73, 19, player->fainted(m) ? 'x' : 'o');}
+	    for(int m = 0; m < cpu->n; m++) {osd->wr_char(m + 21, 5, cpu->fainted(m) ? 'x' : 'o');}
 
-
-	}
-
-	void MewtwoAtk(Pokemon& snorlax, Pokemon& mewtwo, OsdCore *osd_p, SpriteCore *mewtwo_p){
-		osd_p->clr_screen();
-		show_status(&frame, &osd, &snorlax, &mewtwo);
-		int random;
-		random = rand() % 4 + 1;
-		switch(random){
-			case 1: {//future sight
-				char m2Future[] = {'M','e','w','t','w','o',' ','u','s','e','d',' ','F','u','t','u','r','e',' ','s','i','g','h','t','!'};
-				for(int i = 0; i < 50; i++) {
-				    mewtwo_p->move_xy(416-i, 47+i);
-				    sleep_ms(5);
-				}
-				mewtwo_p->move_xy(416,47);
-				snorlax.health = snorlax.health - mewtwo.moves[0].damage;
-				//uart.disp(snorlax.health);
-				for(int i = 0; i < 25; i++){
-					osd_p->wr_char(i + 5, 24, m2Future[i]);
-					sleep_ms(25);
-				}
-				if(snorlax.health < 0){
-					snorlax.isFainted = true;
-					fainted(&osd, snorlax);
-				}
-				break;
-			}
-			case 2: {//psychic
-				char m2Psychic[] = {'M','e','w','t','w','o',' ','u','s','e','d',' ','P','s','y','c','h','i','c','!'};
-				for(int i = 0; i < 50; i++) {
-				    mewtwo_p->move_xy(416-i, 47+i);
-				    sleep_ms(5);
-				}
-				mewtwo_p->move_xy(416,47);
-				snorlax.health = snorlax.health - mewtwo.moves[1].damage;
-				//uart.disp(snorlax.health);
-				for(int i = 0; i < 20; i++){
-					osd_p->wr_char(i + 5, 24, m2Psychic[i]);
-					sleep_ms(25);
-				}
-				if(snorlax.health < 0){
-					snorlax.isFainted = true;
-					fainted(&osd, snorlax);
-				}
-				break;
-			}
-			case 3: {//psystrike
-				char m2Psystrike[] = {'M','e','w','t','w','o',' ','u','s','e','d',' ','P','s','y','s','t','r','i','k','e','!'};
-				for(int i = 0; i < 50; i++) {
-				    mewtwo_p->move_xy(416-i, 47+i);
-				    sleep_ms(5);
-				}
-				mewtwo_p->move_xy(416,47);
-				snorlax.health = snorlax.health - mewtwo.moves[2].damage;
-				//uart.disp(snorlax.health);
-				for(int i = 0; i < 22; i++){
-					osd_p->wr_char(i + 5, 24, m2Psystrike[i]);
-					sleep_ms(25);
-				}
-				if(snorlax.health < 0){
-					snorlax.isFainted = true;
-					fainted(&osd, snorlax);
-				}
-				break;
-			}
-			case 4: {//giga impact
-				char m2Giga[] = {'M','e','w','t','w','o',' ','u','s','e','d',' ','G','i','g','a',' ','I','m','p','a','c','t','!'};
-				for(int i = 0; i < 50; i++) {
-				    mewtwo_p->move_xy(416-i, 47+i);
-				    sleep_ms(5);
-				}
-				mewtwo_p->move_xy(416,47);
-				snorlax.health = snorlax.health - mewtwo.moves[3].damage;
-				//uart.disp(snorlax.health);
-				for(int i = 0; i < 24; i++){
-					osd_p->wr_char(i + 5, 24, m2Giga[i]);
-					sleep_ms(25);
-				}
-				if(snorlax.health < 0){
-					snorlax.isFainted = true;
-					fainted(&osd, snorlax);
-				}
-				break;
-			}
-		}
-	}
+	    hpBar(osd, *player, *cpu);
 
 
-	void SnorlaxMove(Ps2Core *ps2_p, Pokemon& snorlax, Pokemon& mewtwo, OsdCore *osd_p, SpriteCore *snorlax_p){
-		char buf = '\0';
-		int moveNum = 0;
-		bool pressed = false;
-		while(pressed == false){
-			if(ps2_p->get_kb_ch(&buf)){
-				pressed = true;
-			}
-		}
-			if(isOneToFour(buf)){
-				int moveNum = (int) asciiToDigit(buf);
-				uart.disp("movenum: ");
-				uart.disp(moveNum);
-				uart.disp("\n\r");
-				uart.disp("buf: ");
-				uart.disp(buf);
-				uart.disp("\n\r");
-				switch(moveNum){
-					case 1://rest
-					{
-						//moveNum = '\0';
-						osd_p->clr_screen();
-						char snorlaxRest[] = {'S','n','o','r','l','a','x',' ','u','s','e','d',' ','R','e','s','t','!'};
-						for(int i = 0; i < 50; i++) {
-						    snorlax_p->move_xy(97+i, 279-i);
-						    sleep_ms(5);
-						}
-						snorlax_p->move_xy(97,279);
-						snorlax.health = snorlax.maxHP;
-						for(int i = 0; i < 18; i++){
-							osd_p->wr_char(i + 5, 24, snorlaxRest[i]);
-							sleep_ms(25);
-						}
-
-						break;
-					}
-
-					case 2://bodyslam
-					{
-						//moveNum = '\0';
-						osd_p->clr_screen();
-						char snorlaxSlam[] = {'S','n','o','r','l','a','x',' ','u','s','e','d',' ','B','o','d','y','s','l','a','m','!'};
-						for(int i = 0; i < 50; i++) {
-							snorlax_p->move_xy(97+i, 279-i);
-							sleep_ms(5);
-						}
-						snorlax_p->move_xy(97,279);
-						mewtwo.health = mewtwo.health - snorlax.moves[1].damage;
-						for(int i = 0; i < 22; i++){
-							osd_p->wr_char(i + 5, 24, snorlaxSlam[i]);
-							sleep_ms(25);
-						}
-						if(mewtwo.health < 0){
-							mewtwo.isFainted = true;
-							fainted(&osd, mewtwo);
-						}
-						break;
-					}
-
-
-					case 3://gigaimpact
-					{
-						//moveNum = '\0';
-						osd_p->clr_screen();
-						char snorlaxGiga[] = {'S','n','o','r','l','a','x',' ','u','s','e','d',' ','G','i','g','a',' ','I','m','p','a','c','t','!'};
-						for(int i = 0; i < 50; i++) {
-						    snorlax_p->move_xy(97+i, 279-i);
-						    sleep_ms(5);
-						}
-						snorlax_p->move_xy(97,279);
-						mewtwo.health = mewtwo.health - snorlax.moves[2].damage;
-						for(int i = 0; i < 25; i++){
-							osd_p->wr_char(i + 5, 24, snorlaxGiga[i]);
-							sleep_ms(25);
-						}
-						if(mewtwo.health < 0){
-							mewtwo.isFainted = true;
-							fainted(&osd, mewtwo);
-						}
-						break;
-					}
-
-
-					case 4://bellydrum
-					{
-						//moveNum = '\0';
-						osd_p->clr_screen();
-						char snorlaxDrum[] = {'S','n','o','r','l','a','x',' ','u','s','e','d',' ','B','e','l','l','y',' ','D','r','u','m','!'};
-						for(int i = 0; i < 50; i++) {
-						    snorlax_p->move_xy(97+i, 279-i);
-						    sleep_ms(5);
-						}
-						snorlax_p->move_xy(97,279);
-						for(int i = 0; i < 24; i++){
-							osd_p->wr_char(i + 5, 24, snorlaxDrum[i]);
-							sleep_ms(25);
-						}
-						snorlax.moves[1].damage *= 2;
-						snorlax.moves[2].damage *= 2;
-						snorlax.health = floor(snorlax.health/2);
-						break;
-					}
-				}
-			}
 	}
 
-
-	double mapValue(double value, double fromMin, double fromMax, double toMin, double toMax) {
-	    // First, normalize the value to the range [0, 1] within the original range
-	    double normalizedValue = (value - fromMin) / (fromMax - fromMin);
-
-	    // Then, scale the normalized value to the new range
-	    double mappedValue = toMin + normalizedValue * (toMax - toMin);
-
-	    return mappedValue;
-	}
-
-	void tapDetection(SpiCore *spi_p, bool &gameOver){
-	    const uint8_t RD_CMD = 0x0b;
-	       const uint8_t PART_ID_REG = 0x02;
-	       const uint8_t DATA_REG = 0x08;
-	       const float raw_max = 127.0 / 2.0;  //128 max 8-bit reading for +/-2g
-	       static double magnitude, magnitudeTemp;
-	       int totalLed, totalLedTemp;
-
-	       int8_t xraw, yraw, zraw;
-	       float x, y, z;
-	       int id;
-
-	       spi_p->set_freq(400000);
-	       spi_p->set_mode(0, 0);
-	       // check part id
-	       spi_p->assert_ss(0);    // activate
-	       spi_p->transfer(RD_CMD);  // for read operation
-	       spi_p->transfer(PART_ID_REG);  // part id address
-	       id = (int) spi_p->transfer(0x00);
-	       spi_p->deassert_ss(0);
-	       spi_p->assert_ss(0);    // activate
-	       spi_p->transfer(RD_CMD);  // for read operation
-	       spi_p->transfer(DATA_REG);  //
-	       xraw = spi_p->transfer(0x00);
-	       yraw = spi_p->transfer(0x00);
-	       zraw = spi_p->transfer(0x00);
-	       spi_p->deassert_ss(0);
-	       x = (float) xraw / raw_max;
-	       y = (float) yraw / raw_max;
-	       z = (float) zraw / raw_max;
-	       magnitude = abs(x)+abs(y)+abs(z);
-
-
-	       if(!(magnitudeTemp <= (magnitude + 0.035) && magnitudeTemp >= (magnitude - 0.035))) {
-	    	   totalLed = (int) mapValue(magnitude, 0.5, 2, 0, 15);
-	    	   if(totalLed >= 5) {gameOver = true;}
-	       }
-	       magnitudeTemp = magnitude;
-	}
-
-	void win_screen(FrameCore *frame_p, OsdCore *osd_p){
-	    frame_p->clr_screen(0xfff);
-	    osd_p->set_color(0x0f0, 0x000);
-	    osd_p->clr_screen();
+	void win_screen(OsdShadow *osd_p){
 	    char win[] = {'Y','O','U',' ','W','I','N'};
 	    for(int i = 0; i < 7; i++){
 	        osd_p->wr_char(i + 38, 10, win[i]);
@@ -594,7 +391,466 @@ public:
 	}
 
 
+/**********************************************************************
+ * game state machine
+ *  - update: fixed 60 Hz step; consumes input, advances the rules
+ *    and animations; never blocks
+ *  - render: writes only what changed since the last frame (osd
+ *    tiles via the shadow, sprite registers, frame on scene change)
+ *********************************************************************/
+enum {
+   GS_TITLE = 0,     // title screen, wait for a press
+   GS_INTRO,         // "a wild mewtwo appeared"
+   GS_MENU,          // move list, wait for a choice
+   GS_PARTY,         // party list, wait for a member to switch in
+   GS_PLAYER_MOVE,   // present the player's move
+   GS_CPU_MOVE,      // present the cpu's move
+   GS_RESULT,        // "... has fainted"
+   GS_GAME_OVER,     // win/lose screen, wait for a press
+   N_GAME_STATES
+};
+enum {
+   SC_NONE = 0,      // frame buffer scenes
+   SC_TITLE,
+   SC_BATTLE,
+   SC_WIN,
+   SC_LOSE
+};
+enum {
+   TICK_US = 16667,       // update step (60 Hz)
+   MAX_CATCHUP = 4,       // # updates run before a late frame is dropped
+   AI_BUDGET_US = 12000,  // cpu search fits in one step
+   LUNGE_TICKS = 15,      // attack animation (250 ms)
+   FAINT_TICKS = 60,      // fainted message (1 s)
+   N_TYPE_LINES = 6
+};
+
+// parties (sprites show the first species of each side)
+const uint8_t PLAYER_TEAM[] = {
+   SP_SNORLAX, SP_LAPRAS, SP_GENGAR, SP_ALAKAZAM, SP_GYARADOS, SP_JOLTEON
+};
+const uint8_t CPU_TEAM[] = {
+   SP_MEWTWO, SP_DRAGONITE, SP_ZAPDOS, SP_MACHAMP, SP_ARCANINE, SP_STARMIE
+};
+
+BattleState st(PLAYER_TEAM, 6, CPU_TEAM, 6);     // rules
+BattleState view(PLAYER_TEAM, 6, CPU_TEAM, 6);   // shown state (follows the events)
+BattleLog turn_log;
+int gs = -1;            // game state
+int gs_ticks;           // ticks spent in the state
+int next_ev;            // next event of turn_log to present
+int hold;               // ticks before the next event
+int lunge_side, lunge_t;
+int scene, scene_drawn;
+int show_spr[2], spr_shown[2] = {-1, -1};
+int spr_x[2] = {-1, -1}, spr_y[2] = {-1, -1};
+unsigned long gs_us[N_GAME_STATES], gs_n[N_GAME_STATES];
+
+SpriteCore *const SPRITES[2] = {&snorlax, &mewtwo};
+const int HOME_X[2] = {97, 416}, HOME_Y[2] = {279, 47};
+const int LUNGE_DX[2] = {1, -1}, LUNGE_DY[2] = {-1, 1};
+
+/**
+ * typewriter: queued lines appear one char per 'every' ticks
+ */
+struct TypeLine {
+   uint8_t x, y, every;
+   char s[40];
+};
+TypeLine type_q[N_TYPE_LINES];
+int type_n, type_cur, type_pos, type_cnt;
+
+void type_clear() {
+   type_n = 0;
+   type_cur = 0;
+   type_pos = 0;
+   type_cnt = 0;
+}
+
+int type_busy() {
+   return (type_cur < type_n);
+}
+
+/**
+ * queue a line (concatenation of up to 4 strings)
+ */
+void type_line(int x, int y, int every, const char *a, const char *b = "",
+      const char *c = "", const char *d = "") {
+   const char *part[4] = {a, b, c, d};
+   TypeLine *l;
+   int n = 0;
+
+   if (type_n == N_TYPE_LINES)
+      return;
+   l = &type_q[type_n];
+   for (int k = 0; k < 4; k++)
+      for (const char *p = part[k]; *p != 0 && n < (int) sizeof(l->s) - 1; p++)
+         l->s[n++] = *p;
+   if (n == 0)
+      return;
+   l->s[n] = 0;
+   l->x = x;
+   l->y = y;
+   l->every = every;
+   type_n++;
+}
+
+void type_step() {
+   TypeLine *l;
+
+   if (!type_busy() || ++type_cnt < type_q[type_cur].every)
+      return;
+   type_cnt = 0;
+   l = &type_q[type_cur];
+   osd_buf.wr_char(l->x + type_pos, l->y, l->s[type_pos]);
+   type_pos++;
+   if (l->s[type_pos] == 0) {
+      type_cur++;
+      type_pos = 0;
+   }
+}
+
+/**
+ * start a session: replay the last battle (switch 1 up) or record
+ */
+void start_session() {
+   uint32_t seed;
+
+   if (sw.read(1) && replay.has_log()) {
+      rng.seed(replay.start_replay());
+   } else {
+      seed = boot_seed(&adc, 16);
+      rng.seed(seed);
+      replay.start_record(seed);
+   }
+   debug("battle seed: ", rng.get_seed(), 0);
+}
+
+/**
+ * leave the current state and run the entry actions of a new one
+ * @param s new state (no action if already in it)
+ */
+void set_state(int s) {
+   int k;
+
+   if (s == gs)
+      return;
+   if (gs >= 0 && gs_n[gs] > 0)
+      debug("state/avg us per tick: ", gs, (int) (gs_us[gs] / gs_n[gs]));
+   gs = s;
+   gs_ticks = 0;
+   switch (s) {
+   case GS_TITLE:
+      scene = SC_TITLE;
+      show_spr[0] = show_spr[1] = 0;
+      osd_buf.clr_screen();
+      start_screen(&osd_buf);
+      sseg.show_hex(rng.get_seed());    // seed shown for bug reports
+      input.flush();
+      break;
+   case GS_INTRO:
+      st.reset();
+      view = st;
+      scene = SC_BATTLE;
+      show_spr[BattleState::PLAYER] = 1;
+      show_spr[BattleState::CPU] = 0;
+      lunge_t = 0;
+      osd_buf.clr_screen();
+      type_clear();
+      type_line(3, 24, 3, "A Wild Mewtwo Appeared!");
+      break;
+   case GS_MENU:
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &st.side[0], &st.side[1]);
+      type_clear();
+      for (k = 0; k < N_MOVE_SLOTS; k++) {
+         const char num[] = {(char) ('1' + k), '.', 0};
+         type_line(5 + 16 * (k & 1), 24 + 2 * (k >> 1), 1, num,
+               pool_str(move_info(st.side[0].move(st.side[0].active, k)).name));
+      }
+      type_line(5, 28, 1, "Select a Move...  (S: switch)");
+      break;
+   case GS_PARTY:
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &st.side[0], &st.side[1]);
+      type_clear();
+      for (k = 0; k < st.side[0].n; k++) {
+         const char num[] = {(char) ('1' + k), '.', 0};
+         const Party &p = st.side[0];
+         type_line(5 + 24 * (k & 1), 24 + 2 * (k >> 1), 1, num, p.name(k),
+               p.fainted(k) ? " (fainted)" : ((k == p.active) ? " (in battle)" : ""));
+      }
+      type_line(60, 28, 1, "S: back");
+      break;
+   case GS_RESULT:
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &view.side[0], &view.side[1]);
+      fainted(&osd_buf, view.side[view.side[0].healthy() ? 1 : 0]);
+      break;
+   case GS_GAME_OVER:
+      seq.stop();
+      replay.stop();
+      // switch 2 up: send the session log to the host
+      if (sw.read(2) && !pcm.active())
+         replay.dump(&uart);
+      type_clear();
+      show_spr[0] = show_spr[1] = 0;
+      osd_buf.clr_screen();
+      if (st.winner == BattleState::PLAYER) {
+         scene = SC_WIN;
+         win_screen(&osd_buf);
+         sseg.scroll("YOU WIN");
+      } else {
+         scene = SC_LOSE;
+         game_over(&osd_buf);
+         sseg.scroll("GAME OVER");
+      }
+      input.flush();
+      break;
+   }
+}
+
+/**
+ * present the next event of the turn once the previous one is shown
+ */
+void update_turn() {
+   if (hold > 0) {
+      hold--;
+      return;
+   }
+   if (lunge_t > 0 || type_busy())
+      return;
+   if (next_ev >= turn_log.n) {
+      set_state(GS_MENU);
+      return;
+   }
+   const BattleEvent &e = turn_log.ev[next_ev++];
+   Party &p = view.side[e.side];
+   switch (e.type) {
+   case BEV_MOVE: {
+      const MoveInfo &m = move_info(e.arg);
+      set_state((e.side == BattleState::PLAYER) ? GS_PLAYER_MOVE : GS_CPU_MOVE);
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &view.side[0], &view.side[1]);
+      lunge_side = e.side;
+      lunge_t = LUNGE_TICKS;
+      if (m.effect == EFF_DAMAGE)
+         sfx_hit();
+      else if (m.effect == EFF_RECOVER || m.effect == EFF_REST)
+         seq.play_sfx(SFX_HEAL);
+      type_line(5, 24, 2, p.name(p.active), " used ", pool_str(m.name), "!");
+      break;
+   }
+   case BEV_DAMAGE:
+      p.hp[p.active] = p.hp[p.active] - e.value;
+      hpBar(&osd_buf, view.side[0], view.side[1]);
+      break;
+   case BEV_HEAL:
+      p.hp[p.active] = p.hp[p.active] + e.value;
+      hpBar(&osd_buf, view.side[0], view.side[1]);
+      break;
+   case BEV_STAT_UP:
+      type_line(5, 26, 2, (e.arg == STAT_ATK) ? "Attack rose!" : "Defense rose!");
+      break;
+   case BEV_EFFECTIVE: {
+      const Party &t = view.side[1 - e.side];
+      if (e.value == 0)
+         type_line(5, 26, 2, "It doesn't affect ", t.name(t.active), "...");
+      else if (e.value > TE_X1)
+         type_line(5, 26, 2, "It's super effective!");
+      else
+         type_line(5, 26, 2, "It's not very effective...");
+      break;
+   }
+   case BEV_FAINT:
+      p.status[p.active] |= Party::ST_FAINTED;
+      if (p.healthy() == 0) {
+         set_state(GS_RESULT);
+         break;
+      }
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &view.side[0], &view.side[1]);
+      fainted(&osd_buf, p);
+      hold = FAINT_TICKS;
+      break;
+   case BEV_SWITCH:
+      set_state((e.side == BattleState::PLAYER) ? GS_PLAYER_MOVE : GS_CPU_MOVE);
+      p.switch_to(e.arg);
+      osd_buf.clr_screen();
+      show_status(&osd_buf, &view.side[0], &view.side[1]);
+      if (e.side == BattleState::PLAYER)
+         type_line(5, 24, 2, "Go! ", p.name(p.active), "!");
+      else
+         type_line(5, 24, 2, "Foe sent out ", p.name(p.active), "!");
+      break;
+   }
+}
+
+/**
+ * run a turn; the rules run at once, the events are presented over
+ * the following ticks
+ * @param act player action
+ */
+void play_turn(int act) {
+   view = st;
+   battle_step(st, act, cpu_move(st), rng.stream(RngService::RNG_DAMAGE), turn_log);
+#ifdef _DEBUG
+   int bad = battle_check(st);
+   if (bad)
+      debug("battle check failed (bits/turn): ", bad, st.turn);
+#endif
+   next_ev = 0;
+   hold = 0;
+   set_state(GS_PLAYER_MOVE);
+}
+
+/**
+ * read the player's move or open the switch menu
+ */
+void update_menu() {
+   InputEvent ev;
+   int act;
+
+   if (type_busy())
+      return;   // presses wait in the queue until the list is shown
+   while (input.pop(&ev)) {
+      if (ev.type == InputService::EV_TAP) {
+         set_state(GS_GAME_OVER);   // tap ends the game
+         return;
+      }
+      if (event_switch(ev)) {
+         set_state(GS_PARTY);
+         return;
+      }
+      act = event_choice(ev, N_MOVE_SLOTS);
+      if (act == 0)
+         continue;
+      debug("movenum/event: ", act, ev.type);
+      play_turn(act - 1);
+      return;
+   }
+}
+
+/**
+ * read the member to switch in
+ */
+void update_party() {
+   InputEvent ev;
+   int m;
+
+   if (type_busy())
+      return;
+   while (input.pop(&ev)) {
+      if (event_switch(ev)) {
+         set_state(GS_MENU);
+         return;
+      }
+      m = event_choice(ev, st.side[0].n);
+      if (m == 0 || !st.side[0].can_switch(m - 1))
+         continue;
+      play_turn(ACT_SWITCH + m - 1);
+      return;
+   }
+}
+
+/**
+ * one fixed update step
+ */
+void game_update() {
+   gs_ticks++;
+   // text appears after the attack animation
+   if (lunge_t > 0)
+      lunge_t--;
+   else
+      type_step();
+   switch (gs) {
+   case GS_TITLE:
+   case GS_GAME_OVER:
+      if (pressed())
+         set_state(GS_INTRO);
+      break;
+   case GS_INTRO:
+      if (type_busy())
+         break;
+      show_status(&osd_buf, &st.side[0], &st.side[1]);
+      show_spr[BattleState::CPU] = 1;
+      seq.play(BATTLE_PATTERNS, BATTLE_ORDER, sizeof(BATTLE_ORDER), 1);
+      input.flush();    // presses made during the intro are not moves
+      start_session();
+      set_state(GS_MENU);
+      break;
+   case GS_MENU:
+      update_menu();
+      break;
+   case GS_PARTY:
+      update_party();
+      break;
+   case GS_PLAYER_MOVE:
+   case GS_CPU_MOVE:
+      update_turn();
+      break;
+   case GS_RESULT:
+      if (gs_ticks >= FAINT_TICKS)
+         set_state(GS_GAME_OVER);
+      break;
+   }
+}
+
+/**
+ * draw the frame buffer background of a scene (slow; scene changes only)
+ */
+void draw_scene(int sc) {
+   switch (sc) {
+   case SC_TITLE:
+      frame.clr_screen(0x000);
+      osd.set_color(0x0ff, 0x111);
+      break;
+   case SC_BATTLE:
+      environmentInit(&frame);
+      osd.set_color(0x111, 0x000);
+      break;
+   case SC_WIN:
+      frame.clr_screen(0xfff);
+      osd.set_color(0x0f0, 0x000);
+      break;
+   case SC_LOSE:
+      frame.clr_screen(0x000);
+      osd.set_color(0xf00, 0x000);
+      break;
+   }
+}
+
+/**
+ * write the changed display state
+ */
+void game_render() {
+   int i, x, y, off;
+
+   if (scene != scene_drawn) {
+      draw_scene(scene);
+      scene_drawn = scene;
+   }
+   for (i = 0; i < 2; i++) {
+      if (show_spr[i] != spr_shown[i]) {
+         SPRITES[i]->bypass(!show_spr[i]);
+         spr_shown[i] = show_spr[i];
+      }
+      off = (lunge_t > 0 && lunge_side == i) ? (LUNGE_TICKS - lunge_t) * 50 / LUNGE_TICKS : 0;
+      x = HOME_X[i] + LUNGE_DX[i] * off;
+      y = HOME_Y[i] + LUNGE_DY[i] * off;
+      if (x != spr_x[i] || y != spr_y[i]) {
+         SPRITES[i]->move_xy(x, y);
+         spr_x[i] = x;
+         spr_y[i] = y;
+      }
+   }
+   osd_buf.flush();
+}
+
+
 int main() {
+   unsigned long next_us, t0;
+   int n, s;
 
 //    Move Rest("Rest", 0, true);
 //    Move BodySlam("Body Slam", 85, false);
@@ -609,109 +865,49 @@ int main() {
 //
 //    Pokemon Mewtwo("MEWTWO", 296, 216, 447, 100, 415, FutureSight, Psychic, Psystrike, GigaImpact);
 
-    //title screen
-    osd.bypass(1);
-    frame.bypass(1);
-    gray.bypass(1);
-    start_screen(&frame, &osd);
-    cursor.bypass(1);
-    mewtwo.bypass(1);
-    snorlax.bypass(1);
-    start_key(&ps2);
-
-    osd.clr_screen();
-
-
-while (1) {
-	    Move Rest("Rest", 0, true);
-	    Move BodySlam("Body Slam", 85, false);
-	    Move GigaImpact("Giga Impact", 150, false);
-	    Move BellyDrum("Belly Drum", 0, true);
-
-	    Pokemon Snorlax("SNORLAX", 96, 319, 283, 100, 523, Rest, BodySlam, GigaImpact, BellyDrum);
-
-	    Move FutureSight("Future Sight", 120, false);
-	    Move Psychic("Psychic", 90, false);
-	    Move Psystrike("Psystrike", 100, false);
-
-	    Pokemon Mewtwo("MEWTWO", 296, 216, 447, 100, 415, FutureSight, Psychic, Psystrike, GigaImpact);
-	    bool gameOver = false;
-	    bool won = false;
-//    test_start(&led);
-  //  bypass all cores
-//    frame.bypass(1);
-      bar.bypass(1);
-      frame.bypass(0);
-      gray.bypass(1);
-      osd.bypass(1);
-      cursor.bypass(1);
-      mewtwo.bypass(1);
-//      osd.bypass(1);
-      snorlax.bypass(1);
-//      sleep_ms(3500);
-      environmentInit(&frame);
-
-
-
-
-      //start positions
-      mewtwo.move_xy(416, 47);
-      snorlax.move_xy(97,279);
-      cursor.move_xy(320, 240);
-
-
-
-      osd.set_color(0x111, 0x000);
-      osd.bypass(0);
-
-	    snorlax.bypass(0);
-	    osd.clr_screen();
-	    char intro[] = {'A',' ','W','i','l','d',' ','M','e','w','t','w','o',' ','A','p','p','e','a','r','e','d','!'};
-	    for(int i = 0; i < 23; i++){
-		    osd.wr_char(i + 3, 24, intro[i]);
-		    sleep_ms(50);
-	    }
-	    show_status(&frame,&osd,&Snorlax,&Mewtwo);
-	    mewtwo.bypass(0);
-	    osd.clr_screen();
-  	  show_status(&frame,&osd,&Snorlax,&Mewtwo);
-
-      while (gameOver == false){
-    	  osd.clr_screen();
-		    show_status(&frame,&osd,&Snorlax,&Mewtwo);
-    	  char moves1[] = {'1','.','R','e','s','t',' ',' ',' ',' ',' ',' ',' ',' ',' ',' ','2','.','B','o','d','y',' ','S','l','a','m'};
-    	  char moves2[] = {'3','.','G','i','g','a',' ','I','m','p','a','c','t',' ',' ','4','.','B','e','l','l','y',' ','d','r','u','m'};
-		    for(int i = 0; i < 27; i++){
-			    osd.wr_char(i + 5, 24, moves1[i]);
-			    osd.wr_char(i + 5, 26, moves2[i]);
-			    sleep_ms(20);
-		    }
-		    char pick[] = {'S','e','l','e','c','t',' ','a',' ','M','o','v','e','.','.','.'};
-		    for(int i = 0; i < 16; i++){
-			    osd.wr_char(i + 5, 28, pick[i]);
-			    sleep_ms(20);
-		    }
-
-		    tapDetection(&spi, gameOver);
-		    show_status(&frame,&osd,&Snorlax,&Mewtwo);
-		    SnorlaxMove(&ps2, Snorlax, Mewtwo, &osd, &snorlax);
-		    show_status(&frame,&osd,&Snorlax,&Mewtwo);
-		    MewtwoAtk(Snorlax, Mewtwo, &osd, &mewtwo);
-		    show_status(&frame,&osd,&Snorlax,&Mewtwo);
-		    tapDetection(&spi, gameOver);
-
-		    if(Mewtwo.isFainted || Snorlax.isFainted)
-			    gameOver = true;
-		    if(Mewtwo.isFainted)
-			    won = true;
-
-        } //while
-      if(gameOver && won)
-    	  win_screen(&frame,&osd);
-      else
-    	  game_over(&frame,&osd);
-      start_key(&ps2);
-   } // while
+   // seed all random streams once; the seed reproduces the session
+   rng.seed(boot_seed(&adc, 64));
+   ai.set_rng(&rng.stream(RngService::RNG_AI));
+   ai.set_budget(AI_BUDGET_US);
+   tap.init();
+   input.init();
+   input.set_log(&replay);
+   mix.init();
+   thermo.init();
+   // switch 0 up at power-on: stream ddfs output for host/pcm_rx
+   if (sw.read(0)) {
+      uart.set_baud_rate(230400);
+      pcm.start(8000);
+   }
+   debug("rng seed: ", rng.get_seed(), 0);
+
+   // fixed layers; scenes and sprites are drawn by game_render()
+   bar.bypass(1);
+   gray.bypass(1);
+   cursor.bypass(1);
+   frame.bypass(0);
+   osd.bypass(0);
+   cursor.move_xy(320, 240);
+   set_state(GS_TITLE);
+
+   // fixed-step updates, one render per pass; background tasks in between
+   next_us = now_us();
+   while (1) {
+      service_tasks();
+      if ((long) (now_us() - next_us) < 0)
+         continue;
+      t0 = now_us();
+      s = gs;
+      for (n = 0; n < MAX_CATCHUP && (long) (now_us() - next_us) >= 0; n++) {
+         game_update();
+         next_us = next_us + TICK_US;
+      }
+      if ((long) (now_us() - next_us) >= 0)
+         next_us = now_us() + TICK_US;   // too far behind: drop the backlog
+      game_render();
+      gs_us[s] = gs_us[s] + (now_us() - t0);
+      gs_n[s] = gs_n[s] + n;
+   }
 } //main
 
 
@@ -0,0 +1,346 @@
+/*****************************************************************//**
+ * @file pokedex.cpp
+ *
+ * @brief species/move tables and move resolution
+ *
+ ********************************************************************/
+
+#include "pokedex.h"
+
+/**********************************************************************
+ * string pool (evaluated at compile time)
+ *  - names stored back to back, each null-terminated
+ *  - offset table is built by scanning the pool once at compile time
+ *********************************************************************/
+namespace {
+
+// pool index of each name; order must match NAME_POOL
+enum {
+   STR_SNORLAX = 0, STR_MEWTWO, STR_LAPRAS, STR_GENGAR, STR_ALAKAZAM,
+   STR_GYARADOS, STR_JOLTEON, STR_DRAGONITE, STR_ZAPDOS, STR_MACHAMP,
+   STR_ARCANINE, STR_STARMIE,
+   STR_REST, STR_BODY_SLAM, STR_GIGA_IMPACT, STR_BELLY_DRUM,
+   STR_FUTURE_SIGHT, STR_PSYCHIC, STR_PSYSTRIKE, STR_AMNESIA,
+   STR_THUNDERBOLT, STR_RECOVER, STR_HYPER_BEAM, STR_ICE_BEAM,
+   STR_SURF, STR_SHADOW_BALL, STR_FLAMETHROWER, STR_EARTHQUAKE,
+   STR_CROSS_CHOP, STR_DRAGON_CLAW, STR_HYDRO_PUMP, STR_DRILL_PECK,
+   STR_EXTREME_SPEED, STR_REFLECT,
+   N_STRS
+};
+
+constexpr char NAME_POOL[] =
+      "SNORLAX\0" "MEWTWO\0" "LAPRAS\0" "GENGAR\0" "ALAKAZAM\0"
+      "GYARADOS\0" "JOLTEON\0" "DRAGONITE\0" "ZAPDOS\0" "MACHAMP\0"
+      "ARCANINE\0" "STARMIE\0"
+      "Rest\0" "Body Slam\0" "Giga Impact\0" "Belly Drum\0"
+      "Future Sight\0" "Psychic\0" "Psystrike\0" "Amnesia\0"
+      "Thunderbolt\0" "Recover\0" "Hyper Beam\0" "Ice Beam\0"
+      "Surf\0" "Shadow Ball\0" "Flamethrower\0" "Earthquake\0"
+      "Cross Chop\0" "Dragon Claw\0" "Hydro Pump\0" "Drill Peck\0"
+      "ExtremeSpeed\0" "Reflect";
+
+struct PoolIndex {
+   uint16_t off[N_STRS];
+   int count;
+   constexpr PoolIndex() : off(), count(1) {
+      for (int i = 0; i < (int) sizeof(NAME_POOL) - 1; i++) {
+         if (NAME_POOL[i] == 0 && count < N_STRS)
+            off[count++] = (uint16_t) (i + 1);
+      }
+   }
+};
+
+constexpr PoolIndex POOL_INDEX;
+static_assert(POOL_INDEX.count == N_STRS, "NAME_POOL and STR_xxx out of sync");
+
+constexpr MoveInfo MOVE_TABLE[N_MOVES] = {
+   /* name              effect          power  type */
+   { STR_REST,          EFF_REST,       0,     TY_PSYCHIC },
+   { STR_BODY_SLAM,     EFF_DAMAGE,     85,    TY_NORMAL },
+   { STR_GIGA_IMPACT,   EFF_DAMAGE,     150,   TY_NORMAL },
+   { STR_BELLY_DRUM,    EFF_BELLY_DRUM, 0,     TY_NORMAL },
+   { STR_FUTURE_SIGHT,  EFF_DAMAGE,     120,   TY_PSYCHIC },
+   { STR_PSYCHIC,       EFF_DAMAGE,     90,    TY_PSYCHIC },
+   { STR_PSYSTRIKE,     EFF_DAMAGE,     100,   TY_PSYCHIC },
+   { STR_AMNESIA,       EFF_DEF_UP,     0,     TY_PSYCHIC },
+   { STR_THUNDERBOLT,   EFF_DAMAGE,     90,    TY_ELECTRIC },
+   { STR_RECOVER,       EFF_RECOVER,    0,     TY_NORMAL },
+   { STR_HYPER_BEAM,    EFF_DAMAGE,     150,   TY_NORMAL },
+   { STR_ICE_BEAM,      EFF_DAMAGE,     90,    TY_ICE },
+   { STR_SURF,          EFF_DAMAGE,     90,    TY_WATER },
+   { STR_SHADOW_BALL,   EFF_DAMAGE,     80,    TY_GHOST },
+   { STR_FLAMETHROWER,  EFF_DAMAGE,     90,    TY_FIRE },
+   { STR_EARTHQUAKE,    EFF_DAMAGE,     100,   TY_GROUND },
+   { STR_CROSS_CHOP,    EFF_DAMAGE,     100,   TY_FIGHTING },
+   { STR_DRAGON_CLAW,   EFF_DAMAGE,     80,    TY_DRAGON },
+   { STR_HYDRO_PUMP,    EFF_DAMAGE,     110,   TY_WATER },
+   { STR_DRILL_PECK,    EFF_DAMAGE,     80,    TY_FLYING },
+   { STR_EXTREME_SPEED, EFF_DAMAGE,     80,    TY_NORMAL },
+   { STR_REFLECT,       EFF_DEF_UP,     0,     TY_PSYCHIC }
+};
+
+constexpr SpeciesInfo SPECIES_TABLE[N_SPECIES] = {
+   /* name         lvl  hp   atk  def  spd   types
+    *    moves */
+   { STR_SNORLAX,  100, 523, 283, 319, 96,  { TY_NORMAL, TY_NONE },
+         { MV_REST, MV_BODY_SLAM, MV_GIGA_IMPACT, MV_BELLY_DRUM } },
+   { STR_MEWTWO,   100, 415, 447, 216, 296, { TY_PSYCHIC, TY_NONE },
+         { MV_FUTURE_SIGHT, MV_PSYCHIC, MV_PSYSTRIKE, MV_GIGA_IMPACT } },
+   { STR_LAPRAS,   100, 464, 206, 196, 156, { TY_WATER, TY_ICE },
+         { MV_SURF, MV_ICE_BEAM, MV_BODY_SLAM, MV_REST } },
+   { STR_GENGAR,   100, 324, 296, 156, 256, { TY_GHOST, TY_NONE },
+         { MV_SHADOW_BALL, MV_THUNDERBOLT, MV_PSYCHIC, MV_HYPER_BEAM } },
+   { STR_ALAKAZAM, 100, 314, 306, 126, 276, { TY_PSYCHIC, TY_NONE },
+         { MV_PSYCHIC, MV_RECOVER, MV_SHADOW_BALL, MV_REFLECT } },
+   { STR_GYARADOS, 100, 394, 286, 194, 198, { TY_WATER, TY_FLYING },
+         { MV_HYDRO_PUMP, MV_EARTHQUAKE, MV_ICE_BEAM, MV_HYPER_BEAM } },
+   { STR_JOLTEON,  100, 334, 256, 156, 296, { TY_ELECTRIC, TY_NONE },
+         { MV_THUNDERBOLT, MV_SHADOW_BALL, MV_BODY_SLAM, MV_REST } },
+   { STR_DRAGONITE, 100, 386, 304, 226, 196, { TY_DRAGON, TY_FLYING },
+         { MV_DRAGON_CLAW, MV_EXTREME_SPEED, MV_EARTHQUAKE, MV_HYPER_BEAM } },
+   { STR_ZAPDOS,   100, 384, 286, 206, 236, { TY_ELECTRIC, TY_FLYING },
+         { MV_THUNDERBOLT, MV_DRILL_PECK, MV_REFLECT, MV_REST } },
+   { STR_MACHAMP,  100, 384, 296, 196, 146, { TY_FIGHTING, TY_NONE },
+         { MV_CROSS_CHOP, MV_EARTHQUAKE, MV_BODY_SLAM, MV_REST } },
+   { STR_ARCANINE, 100, 384, 256, 196, 226, { TY_FIRE, TY_NONE },
+         { MV_FLAMETHROWER, MV_EXTREME_SPEED, MV_BODY_SLAM, MV_REST } },
+   { STR_STARMIE,  100, 324, 236, 206, 266, { TY_WATER, TY_PSYCHIC },
+         { MV_SURF, MV_PSYCHIC, MV_THUNDERBOLT, MV_RECOVER } }
+};
+
+/**********************************************************************
+ * stat stages (evaluated at compile time)
+ *  - Q8 factor (2+s)/2 for s > 0, 2/(2-s) for s <= 0
+ *********************************************************************/
+struct StageTable {
+   int16_t q8[2 * MAX_STAGE + 1];
+   constexpr StageTable() : q8() {
+      for (int s = -MAX_STAGE; s <= MAX_STAGE; s++)
+         q8[s + MAX_STAGE] = (int16_t) ((s > 0) ? 128 * (2 + s) : 512 / (2 - s));
+   }
+};
+
+constexpr StageTable STAGE_TABLE;
+
+/**********************************************************************
+ * type chart (evaluated at compile time)
+ *  - one 32-bit row per attacking type, 2 bits per defending type:
+ *    0: x0, 1: x0.5, 2: x1, 3: x2
+ *  - built from the list of non-neutral matchups
+ *********************************************************************/
+enum {
+   TE_0 = 0, TE_HALF, TE_1, TE_2
+};
+
+struct TypeMatch {
+   uint8_t atk, def, code;
+};
+
+constexpr TypeMatch TYPE_MATCHES[] = {
+   { TY_NORMAL, TY_GHOST, TE_0 },
+   { TY_FIRE, TY_FIRE, TE_HALF }, { TY_FIRE, TY_WATER, TE_HALF },
+   { TY_FIRE, TY_ICE, TE_2 }, { TY_FIRE, TY_DRAGON, TE_HALF },
+   { TY_WATER, TY_FIRE, TE_2 }, { TY_WATER, TY_WATER, TE_HALF },
+   { TY_WATER, TY_GROUND, TE_2 }, { TY_WATER, TY_DRAGON, TE_HALF },
+   { TY_ELECTRIC, TY_WATER, TE_2 }, { TY_ELECTRIC, TY_ELECTRIC, TE_HALF },
+   { TY_ELECTRIC, TY_GROUND, TE_0 }, { TY_ELECTRIC, TY_FLYING, TE_2 },
+   { TY_ELECTRIC, TY_DRAGON, TE_HALF },
+   { TY_ICE, TY_FIRE, TE_HALF }, { TY_ICE, TY_WATER, TE_HALF },
+   { TY_ICE, TY_ICE, TE_HALF }, { TY_ICE, TY_GROUND, TE_2 },
+   { TY_ICE, TY_FLYING, TE_2 }, { TY_ICE, TY_DRAGON, TE_2 },
+   { TY_FIGHTING, TY_NORMAL, TE_2 }, { TY_FIGHTING, TY_ICE, TE_2 },
+   { TY_FIGHTING, TY_FLYING, TE_HALF }, { TY_FIGHTING, TY_PSYCHIC, TE_HALF },
+   { TY_FIGHTING, TY_GHOST, TE_0 },
+   { TY_GROUND, TY_FIRE, TE_2 }, { TY_GROUND, TY_ELECTRIC, TE_2 },
+   { TY_GROUND, TY_FLYING, TE_0 },
+   { TY_FLYING, TY_ELECTRIC, TE_HALF }, { TY_FLYING, TY_FIGHTING, TE_2 },
+   { TY_PSYCHIC, TY_FIGHTING, TE_2 }, { TY_PSYCHIC, TY_PSYCHIC, TE_HALF },
+   { TY_GHOST, TY_NORMAL, TE_0 }, { TY_GHOST, TY_PSYCHIC, TE_2 },
+   { TY_GHOST, TY_GHOST, TE_2 },
+   { TY_DRAGON, TY_DRAGON, TE_2 }
+};
+
+struct TypeChart {
+   uint32_t row[N_TYPES];
+   constexpr TypeChart() : row() {
+      for (int a = 0; a < N_TYPES; a++)
+         for (int d = 0; d < N_TYPES; d++)
+            row[a] = row[a] | ((uint32_t) TE_1 << (2 * d));   // x1 by default
+      for (const TypeMatch &t : TYPE_MATCHES)
+         row[t.atk] = (row[t.atk] & ~(3u << (2 * t.def))) | ((uint32_t) t.code << (2 * t.def));
+   }
+};
+
+constexpr TypeChart TYPE_CHART;
+static_assert(N_TYPES <= 16, "type chart row holds 16 types");
+
+// chart code to quarters: 0, 2, 4, 8
+inline int chart_quarters(int atk, int def) {
+   int code = (TYPE_CHART.row[atk] >> (2 * def)) & 0x03;
+
+   return ((code == TE_0) ? 0 : (1 << code));
+}
+
+}  // namespace
+
+const MoveInfo &move_info(int move) {
+   return (MOVE_TABLE[move]);
+}
+
+const SpeciesInfo &species_info(int species) {
+   return (SPECIES_TABLE[species]);
+}
+
+const char *pool_str(int idx) {
+   return (&NAME_POOL[POOL_INDEX.off[idx]]);
+}
+
+/**********************************************************************
+ * Party
+ *********************************************************************/
+Party::Party(const uint8_t *sp, int count) {
+   int m;
+
+   n = (uint8_t) ((count > MAX_MEMBERS) ? MAX_MEMBERS : count);
+   for (m = 0; m < MAX_MEMBERS; m++)
+      species[m] = (m < n) ? sp[m] : 0;
+   reset();
+}
+
+Party::~Party() {
+}  // not used
+
+void Party::reset() {
+   int m;
+
+   for (m = 0; m < MAX_MEMBERS; m++) {
+      const SpeciesInfo &s = SPECIES_TABLE[species[m]];
+      hp[m] = (m < n) ? (int16_t) s.hp : 0;
+      atk_stage[m] = 0;
+      def_stage[m] = 0;
+      status[m] = (m < n) ? 0 : ST_FAINTED;
+   }
+   active = 0;
+}
+
+const char *Party::name(int m) const {
+   return (pool_str(SPECIES_TABLE[species[m]].name));
+}
+
+int Party::max_hp(int m) const {
+   return (SPECIES_TABLE[species[m]].hp);
+}
+
+int Party::attack(int m) const {
+   return (stage_stat(SPECIES_TABLE[species[m]].atk, atk_stage[m]));
+}
+
+int Party::defense(int m) const {
+   return (stage_stat(SPECIES_TABLE[species[m]].def, def_stage[m]));
+}
+
+int Party::speed(int m) const {
+   return (SPECIES_TABLE[species[m]].spd);
+}
+
+int Party::move(int m, int slot) const {
+   return (SPECIES_TABLE[species[m]].moves[slot]);
+}
+
+int Party::fainted(int m) const {
+   return (status[m] & ST_FAINTED);
+}
+
+int Party::healthy() const {
+   int m, cnt = 0;
+
+   for (m = 0; m < n; m++)
+      cnt = cnt + !(status[m] & ST_FAINTED);
+   return (cnt);
+}
+
+int Party::can_switch(int m) const {
+   return (m >= 0 && m < n && m != active && !(status[m] & ST_FAINTED));
+}
+
+void Party::switch_to(int m) {
+   atk_stage[active] = 0;
+   def_stage[active] = 0;
+   active = (uint8_t) m;
+}
+
+/**********************************************************************
+ * damage
+ *********************************************************************/
+int stage_stat(int stat, int stage) {
+   return ((stat * STAGE_TABLE.q8[stage + MAX_STAGE]) >> 8);
+}
+
+int type_effect(int move_type, int species) {
+   const SpeciesInfo &s = SPECIES_TABLE[species];
+   int q;
+
+   q = chart_quarters(move_type, s.type[0]);
+   if (s.type[1] != TY_NONE)
+      q = (q * chart_quarters(move_type, s.type[1])) >> 2;
+   return (q);
+}
+
+int calc_damage(const Party &user, int move, const Party &target, int roll) {
+   const MoveInfo &mv = MOVE_TABLE[move];
+   const SpeciesInfo &us = SPECIES_TABLE[user.species[user.active]];
+   int32_t dmg;
+   int te;
+
+   te = type_effect(mv.type, target.species[target.active]);
+   if (te == 0)
+      return (0);
+   // one variable division; /5 is by a constant
+   dmg = (int32_t) (2 * us.level / 5 + 2) * mv.power * user.attack(user.active);
+   dmg = dmg / (50 * target.defense(target.active)) + 2;
+   if (mv.type == us.type[0] || mv.type == us.type[1])
+      dmg = dmg + (dmg >> 1);   // same-type bonus
+   dmg = (dmg * te) >> 2;
+   dmg = (dmg * roll) >> 8;
+   return ((dmg < 1) ? 1 : (int) dmg);
+}
+
+/**********************************************************************
+ * move resolution
+ *********************************************************************/
+int apply_move(Party &user, int move, Party &target, Prng &rng) {
+   const MoveInfo &m = MOVE_TABLE[move];
+   int u = user.active;
+   int t = target.active;
+   int dmg = 0;
+
+   switch (m.effect) {
+   case EFF_DAMAGE:
+      dmg = calc_damage(user, move, target, rng.range(ROLL_MIN, ROLL_MAX));
+      if (dmg > target.hp[t])
+         dmg = target.hp[t];
+      target.hp[t] = (int16_t) (target.hp[t] - dmg);
+      if (target.hp[t] == 0)
+         target.status[t] |= Party::ST_FAINTED;
+      break;
+   case EFF_RECOVER:
+      user.hp[u] = (int16_t) (user.hp[u] + user.max_hp(u) / 2);
+      if (user.hp[u] > user.max_hp(u))
+         user.hp[u] = (int16_t) user.max_hp(u);
+      break;
+   case EFF_REST:
+      user.hp[u] = (int16_t) user.max_hp(u);
+      break;
+   case EFF_DEF_UP:
+      user.def_stage[u] = (int8_t) ((user.def_stage[u] + 2 > MAX_STAGE) ? MAX_STAGE : user.def_stage[u] + 2);
+      break;
+   case EFF_BELLY_DRUM:
+      // fails if it would faint the user or attack is maxed
+      if (user.hp[u] > user.max_hp(u) / 2 && user.atk_stage[u] < MAX_STAGE) {
+         user.hp[u] = (int16_t) (user.hp[u] - user.max_hp(u) / 2);
+         user.atk_stage[u] = MAX_STAGE;
+      }
+      break;
+   }
+   return (dmg);
+}
@@ -0,0 +1,290 @@
+/*****************************************************************//**
+ * @file pokedex.h
+ *
+ * @brief species/move tables and per-battle party state
+ *
+ * Description:
+ *  - species and moves are constexpr tables in ROM; each entry holds
+ *    its stats and the index of its name in a shared string pool
+ *  - a move's behavior is an effect code; apply_move() resolves it
+ *    with a switch (no string compare)
+ *  - damage uses integer math only: stat stages scale a stat by a
+ *    Q8 factor from a constexpr table, type effectiveness comes
+ *    from a 2-bit packed chart, the random roll is Q8; the only
+ *    variable division is attack/defense
+ *  - Party holds up to 6 members as a struct of arrays: species
+ *    index plus the mutable battle state in small integer arrays;
+ *    everything else is looked up in the ROM tables, so adding
+ *    species/moves costs no RAM and a party copies as a few dozen
+ *    bytes
+ *
+ *********************************************************************/
+
+#ifndef _POKEDEX_H_INCLUDED
+#define _POKEDEX_H_INCLUDED
+
+#include <inttypes.h>
+#include "prng.h"
+
+/**
+ * move ids (index into move table)
+ */
+enum {
+   MV_REST = 0,
+   MV_BODY_SLAM,
+   MV_GIGA_IMPACT,
+   MV_BELLY_DRUM,
+   MV_FUTURE_SIGHT,
+   MV_PSYCHIC,
+   MV_PSYSTRIKE,
+   MV_AMNESIA,
+   MV_THUNDERBOLT,
+   MV_RECOVER,
+   MV_HYPER_BEAM,
+   MV_ICE_BEAM,
+   MV_SURF,
+   MV_SHADOW_BALL,
+   MV_FLAMETHROWER,
+   MV_EARTHQUAKE,
+   MV_CROSS_CHOP,
+   MV_DRAGON_CLAW,
+   MV_HYDRO_PUMP,
+   MV_DRILL_PECK,
+   MV_EXTREME_SPEED,
+   MV_REFLECT,
+   N_MOVES
+};
+
+/**
+ * species ids (index into species table)
+ */
+enum {
+   SP_SNORLAX = 0,
+   SP_MEWTWO,
+   SP_LAPRAS,
+   SP_GENGAR,
+   SP_ALAKAZAM,
+   SP_GYARADOS,
+   SP_JOLTEON,
+   SP_DRAGONITE,
+   SP_ZAPDOS,
+   SP_MACHAMP,
+   SP_ARCANINE,
+   SP_STARMIE,
+   N_SPECIES
+};
+
+/**
+ * types (only those of the species in the table)
+ */
+enum {
+   TY_NORMAL = 0,
+   TY_FIRE,
+   TY_WATER,
+   TY_ELECTRIC,
+   TY_ICE,
+   TY_FIGHTING,
+   TY_GROUND,
+   TY_FLYING,
+   TY_PSYCHIC,
+   TY_GHOST,
+   TY_DRAGON,
+   N_TYPES,
+   TY_NONE = 0xff    /**< second type of a single-type species */
+};
+
+/**
+ * move effects
+ */
+enum {
+   EFF_DAMAGE = 0,   /**< target loses hp (damage formula) */
+   EFF_RECOVER,      /**< user heals half of its max hp */
+   EFF_REST,         /**< user heals to max hp */
+   EFF_DEF_UP,       /**< user defense +2 stages */
+   EFF_BELLY_DRUM    /**< user loses half its max hp; attack to +6 */
+};
+
+/**
+ * symbolic constants
+ */
+enum {
+   N_MOVE_SLOTS = 4,   /**< # moves per species */
+   MAX_STAGE = 6,      /**< stat stages run -MAX_STAGE to +MAX_STAGE */
+   ROLL_MIN = 218,     /**< random damage roll: ROLL_MIN to 256 (Q8, 85-100%) */
+   ROLL_MAX = 256,
+   TE_X1 = 4           /**< type effectiveness unit (quarters: 0, 1, 2, 4, 8, 16) */
+};
+
+/**
+ * move table entry
+ */
+struct MoveInfo {
+   uint8_t name;     // string pool index
+   uint8_t effect;   // EFF_xxx
+   uint8_t power;    // power of EFF_DAMAGE moves
+   uint8_t type;     // TY_xxx
+};
+
+/**
+ * species table entry
+ */
+struct SpeciesInfo {
+   uint8_t name;     // string pool index
+   uint8_t level;
+   uint16_t hp, atk, def, spd;
+   uint8_t type[2];  // TY_xxx; type[1] may be TY_NONE
+   uint8_t moves[N_MOVE_SLOTS];
+};
+
+/**
+ * read-only tables
+ */
+const MoveInfo &move_info(int move);
+const SpeciesInfo &species_info(int species);
+
+/**
+ * name from the string pool
+ *
+ * @param idx string pool index
+ * @return null-terminated name (in ROM)
+ *
+ */
+const char *pool_str(int idx);
+
+/**
+ * battle state of a party (struct of arrays)
+ *  - member m: species[m], hp[m], ...; stats not listed here come
+ *    from species_info(species[m])
+ *  - the member in battle is 'active'; moves act on the active
+ *    members of both parties
+ *
+ */
+class Party {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      MAX_MEMBERS = 6,   /**< max # members */
+      ST_FAINTED = 0x01  /**< status bit: hp reached 0 */
+   };
+
+   uint8_t n;                       // # members
+   uint8_t active;                  // member in battle
+   uint8_t species[MAX_MEMBERS];
+   uint8_t status[MAX_MEMBERS];     // ST_xxx bits
+   int8_t atk_stage[MAX_MEMBERS];   // -MAX_STAGE to +MAX_STAGE
+   int8_t def_stage[MAX_MEMBERS];
+   int16_t hp[MAX_MEMBERS];
+
+   /**
+    * constructor
+    *
+    * @param sp species ids of the members
+    * @param count # members (1 to MAX_MEMBERS)
+    *
+    */
+   Party(const uint8_t *sp, int count);
+   ~Party();  // not used
+
+   /**
+    * restore full hp, clear battle modifiers, first member active
+    *
+    */
+   void reset();
+
+   const char *name(int m) const;
+   int max_hp(int m) const;
+
+   /**
+    * stats with the stage multiplier applied
+    *
+    */
+   int attack(int m) const;
+   int defense(int m) const;
+   int speed(int m) const;
+
+   /**
+    * move id in a slot
+    *
+    * @param m member
+    * @param slot move slot (0 to N_MOVE_SLOTS-1)
+    *
+    */
+   int move(int m, int slot) const;
+
+   int fainted(int m) const;
+
+   /**
+    * # members able to battle
+    *
+    */
+   int healthy() const;
+
+   /**
+    * check whether member m may be switched in
+    *
+    * @return 1: m exists, is not fainted and not active
+    *
+    */
+   int can_switch(int m) const;
+
+   /**
+    * switch in member m; modifiers of the member leaving are cleared
+    *
+    * @param m member (must pass can_switch())
+    *
+    */
+   void switch_to(int m);
+};
+
+/**
+ * scale a stat by its stage
+ *
+ * @param stat stat value
+ * @param stage -MAX_STAGE to +MAX_STAGE
+ * @return stat * (2+stage)/2 for stage > 0, stat * 2/(2-stage) otherwise
+ *
+ */
+int stage_stat(int stat, int stage);
+
+/**
+ * type effectiveness of a move type against a species
+ *
+ * @param move_type TY_xxx of the move
+ * @param species defending species
+ * @return multiplier in quarters (TE_X1 is neutral)
+ *
+ */
+int type_effect(int move_type, int species);
+
+/**
+ * damage of a move between the active members (no state change)
+ *
+ * @param user attacking party
+ * @param move move id (EFF_DAMAGE)
+ * @param target defending party
+ * @param roll random factor in Q8 (ROLL_MIN to ROLL_MAX)
+ * @return hp the target would lose (not clamped to its hp)
+ * @note ((2L/5+2) * power * atk / def) / 50 + 2, then same-type bonus
+ *       (x1.5), type effectiveness and the roll; at least 1 unless
+ *       the target is immune
+ *
+ */
+int calc_damage(const Party &user, int move, const Party &target, int roll);
+
+/**
+ * resolve a move between the active members of two parties
+ *
+ * @param user party using the move
+ * @param move move id
+ * @param target opposing party
+ * @param rng random source of the damage roll
+ * @return hp lost by the target (0 for non-damaging moves)
+ * @note hp is clamped at 0 and ST_FAINTED is set when it reaches 0
+ *
+ */
+int apply_move(Party &user, int move, Party &target, Prng &rng);
+
+#endif  // _POKEDEX_H_INCLUDED
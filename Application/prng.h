@@ -0,0 +1,190 @@
+/*****************************************************************//**
+ * @file prng.h
+ *
+ * @brief seedable pseudo-random number generators with streams
+ *
+ * Description:
+ *  - Prng: xorshift32 with explicit state; the same seed gives the
+ *    same sequence on the board and on the host
+ *  - bounded ranges use Lemire's multiply-shift (no division on the
+ *    common path; a rare rejection step keeps them unbiased)
+ *  - RngService derives independent streams (ai, damage rolls,
+ *    visual effects) from one master seed, so extra effect draws
+ *    never shift the battle sequence; recording the master seed is
+ *    enough to replay a battle
+ *
+ *********************************************************************/
+
+#ifndef _PRNG_H_INCLUDED
+#define _PRNG_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * 32-bit avalanche mix (murmur3 finalizer)
+ *
+ * @param x input
+ * @return mixed value (0 only for 0)
+ *
+ */
+inline uint32_t mix32(uint32_t x) {
+   x ^= x >> 16;
+   x *= 0x85ebca6b;
+   x ^= x >> 13;
+   x *= 0xc2b2ae35;
+   x ^= x >> 16;
+   return (x);
+}
+
+/**
+ * xorshift32 generator
+ *
+ */
+class Prng {
+public:
+   /**
+    * constructor
+    *
+    * @param s seed (0 is replaced by a nonzero constant)
+    *
+    */
+   Prng(uint32_t s = 1) {
+      seed(s);
+   }
+
+   /**
+    * restart the sequence
+    *
+    * @param s seed
+    *
+    */
+   void seed(uint32_t s) {
+      state = (s == 0) ? 0x2545f491 : s;
+   }
+
+   /**
+    * current state (to save/restore a position in the sequence)
+    *
+    */
+   uint32_t get_state() const {
+      return (state);
+   }
+
+   /**
+    * next 32-bit number
+    *
+    */
+   uint32_t next() {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return (state);
+   }
+
+   /**
+    * number in 0 to n-1 (unbiased)
+    *
+    * @param n range (1 or more)
+    * @note the % only runs when a draw lands in the biased zone
+    *       (probability n/2^32)
+    *
+    */
+   int below(int n) {
+      uint64_t m;
+      uint32_t lo, thr;
+
+      m = (uint64_t) next() * (uint32_t) n;
+      lo = (uint32_t) m;
+      if (lo < (uint32_t) n) {
+         thr = (0u - (uint32_t) n) % (uint32_t) n;
+         while (lo < thr) {
+            m = (uint64_t) next() * (uint32_t) n;
+            lo = (uint32_t) m;
+         }
+      }
+      return ((int) (m >> 32));
+   }
+
+   /**
+    * number in lo to hi (inclusive)
+    *
+    */
+   int range(int lo, int hi) {
+      return (lo + below(hi - lo + 1));
+   }
+
+   /**
+    * true with probability num/den
+    *
+    */
+   int chance(int num, int den) {
+      return (below(den) < num);
+   }
+
+private:
+   uint32_t state;
+};
+
+/**
+ * per-subsystem streams from one master seed
+ *
+ */
+class RngService {
+public:
+   /**
+    * streams
+    *
+    */
+   enum {
+      RNG_AI = 0,    /**< ai tie breaks */
+      RNG_DAMAGE,    /**< battle rules (damage rolls) */
+      RNG_FX,        /**< visual/sound effects */
+      N_STREAMS
+   };
+
+   /**
+    * constructor
+    *
+    * @param master master seed
+    *
+    */
+   RngService(uint32_t master = 1) {
+      seed(master);
+   }
+
+   /**
+    * restart all streams
+    *
+    * @param master master seed
+    *
+    */
+   void seed(uint32_t master) {
+      master_seed = master;
+      for (int i = 0; i < N_STREAMS; i++)
+         s[i].seed(mix32(master + 0x9e3779b9u * (uint32_t) (i + 1)));
+   }
+
+   /**
+    * master seed (record it to replay a session)
+    *
+    */
+   uint32_t get_seed() const {
+      return (master_seed);
+   }
+
+   /**
+    * generator of a stream
+    *
+    * @param id stream (RNG_xxx)
+    *
+    */
+   Prng &stream(int id) {
+      return (s[id]);
+   }
+
+private:
+   uint32_t master_seed;
+   Prng s[N_STREAMS];
+};
+
+#endif  // _PRNG_H_INCLUDED
@@ -0,0 +1,167 @@
+/*****************************************************************//**
+ * @file replay.cpp
+ *
+ * @brief implementation of ReplayLog class
+ *
+ ********************************************************************/
+
+#include "replay.h"
+
+ReplayLog::ReplayLog() {
+   n_words = 0;
+   rd = 0;
+   _mode = MODE_OFF;
+   ovf = 0;
+   last_ms = 0;
+}
+
+ReplayLog::~ReplayLog() {
+}  // not used
+
+void ReplayLog::start_record(uint32_t seed) {
+   n_words = 0;
+   ovf = 0;
+   _mode = MODE_RECORD;
+   last_ms = now_ms();
+   put_rec(REC_SEED, 0, 0, last_ms);
+   put(seed);
+}
+
+uint32_t ReplayLog::start_replay() {
+   if (!has_log()) {
+      _mode = MODE_OFF;
+      return (0);
+   }
+   rd = 2;
+   _mode = MODE_REPLAY;
+   last_ms = now_ms();
+   return (buf[1]);
+}
+
+void ReplayLog::stop() {
+   _mode = MODE_OFF;
+}
+
+int ReplayLog::mode() {
+   return (_mode);
+}
+
+int ReplayLog::has_log() {
+   return (n_words >= 2 && ((buf[0] >> 9) & 0x07) == REC_SEED);
+}
+
+int ReplayLog::words() {
+   return (n_words);
+}
+
+int ReplayLog::overflow() {
+   return (ovf);
+}
+
+// a full buffer ends the recording; the stored part stays replayable
+void ReplayLog::put(uint32_t w) {
+   if (n_words >= LOG_WORDS) {
+      ovf = 1;
+      _mode = MODE_OFF;
+      return;
+   }
+   buf[n_words++] = w;
+}
+
+void ReplayLog::put_rec(int type, int code, int value, unsigned long ms) {
+   unsigned long dt;
+
+   // input is logged in consumption order, so an event seen before the
+   // previous record may come after it; keep the deltas non-negative
+   if (ms < last_ms)
+      ms = last_ms;
+   dt = ms - last_ms;
+   last_ms = ms;
+   while (dt > MAX_DT) {
+      put(((uint32_t) MAX_DT << 12) | (REC_TIME << 9));
+      dt = dt - MAX_DT;
+   }
+   put(((uint32_t) dt << 12) | ((uint32_t) type << 9) | ((value & 0x01) << 8)
+         | (code & 0xff));
+}
+
+void ReplayLog::put_input(const InputEvent &ev) {
+   if (_mode == MODE_RECORD)
+      put_rec(ev.type, ev.code, ev.value, ev.ms);
+}
+
+void ReplayLog::put_ai(int depth) {
+   if (_mode == MODE_RECORD)
+      put_rec(REC_AI, depth, 0, now_ms());
+}
+
+/*
+ * read the next record of the wanted kind (-1: any input event);
+ * anything else means the game went out of step with the log
+ */
+int ReplayLog::get_rec(int want, int *code, int *value, unsigned long *ms) {
+   uint32_t w;
+   int type;
+
+   if (_mode != MODE_REPLAY)
+      return (0);
+   while (rd < n_words) {
+      w = buf[rd++];
+      type = (w >> 9) & 0x07;
+      last_ms = last_ms + (w >> 12);
+      if (type == REC_TIME)
+         continue;
+      if ((want < 0 && type < REC_AI) || type == want) {
+         *code = w & 0xff;
+         *value = (w >> 8) & 0x01;
+         *ms = last_ms;
+         return (1);
+      }
+      break;
+   }
+   _mode = MODE_OFF;   // end of log or out of step: live input takes over
+   return (0);
+}
+
+int ReplayLog::get_input(InputEvent *ev) {
+   int code, value;
+   unsigned long ms;
+
+   if (!get_rec(-1, &code, &value, &ms))
+      return (0);
+   ev->ms = (uint32_t) ms;
+   ev->type = (uint8_t) ((buf[rd - 1] >> 9) & 0x07);
+   ev->code = (uint8_t) code;
+   ev->value = (uint8_t) value;
+   return (1);
+}
+
+int ReplayLog::get_ai() {
+   int code, value;
+   unsigned long ms;
+
+   if (!get_rec(REC_AI, &code, &value, &ms))
+      return (0);
+   return (code);
+}
+
+void ReplayLog::dump(UartCore *uart) {
+   uint8_t chk;
+   uint32_t w;
+   int i, k;
+
+   uart->tx_byte(SYNC0);
+   uart->tx_byte(SYNC1);
+   uart->tx_byte((uint8_t) n_words);
+   uart->tx_byte((uint8_t) (n_words >> 8));
+   chk = 0;
+   for (i = 0; i < n_words; i++) {
+      w = buf[i];
+      for (k = 0; k < 4; k++) {
+         uart->tx_byte((uint8_t) w);
+         chk = chk ^ (uint8_t) w;
+         w = w >> 8;
+      }
+   }
+   uart->tx_byte(chk);
+}
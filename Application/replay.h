@@ -0,0 +1,166 @@
+/*****************************************************************//**
+ * @file replay.h
+ *
+ * @brief input log recording and deterministic replay
+ *
+ * Description:
+ *  - a session (one battle) is fully determined by its rng seed, the
+ *    input events the game consumed and the depth each ai search
+ *    reached; the log stores exactly these, in consumption order
+ *  - one 32-bit word per record:
+ *      bits 31-12: ms since the previous record (REC_TIME extends it)
+ *      bits 11-9 : record type (InputService::EV_xxx or REC_xxx)
+ *      bit 8     : event value
+ *      bits 7-0  : event code / ai depth
+ *    the seed record is followed by the raw 32-bit seed
+ *  - the log lives in a fixed RAM buffer; when it fills up, recording
+ *    stops (a replay then ends early and live input takes over)
+ *  - dump() sends the log over the uart for replay on another board
+ *    or on the host
+ *
+ *********************************************************************/
+
+#ifndef _REPLAY_H_INCLUDED
+#define _REPLAY_H_INCLUDED
+
+#include "chu_init.h"
+#include "input.h"
+
+/**
+ * session log
+ *
+ */
+class ReplayLog {
+public:
+   /**
+    * modes
+    *
+    */
+   enum {
+      MODE_OFF = 0,
+      MODE_RECORD,
+      MODE_REPLAY
+   };
+   /**
+    * record types beyond InputService::EV_xxx
+    *
+    */
+   enum {
+      REC_AI = 4,     /**< code: depth of an ai search */
+      REC_SEED = 5,   /**< next word: rng master seed */
+      REC_TIME = 6    /**< time extension only */
+   };
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      LOG_WORDS = 1024,          /**< buffer size in 32-bit records */
+      MAX_DT = (1 << 20) - 1,    /**< largest ms delta in one record */
+      SYNC0 = 0x52,              /**< dump header 'R' */
+      SYNC1 = 0x4c               /**< dump header 'L' */
+   };
+
+   /**
+    * constructor
+    *
+    */
+   ReplayLog();
+   ~ReplayLog();  // not used
+
+   /**
+    * clear the buffer and start recording a session
+    *
+    * @param seed rng master seed of the session
+    *
+    */
+   void start_record(uint32_t seed);
+
+   /**
+    * replay the recorded session from the start
+    *
+    * @return rng master seed of the session
+    * @note returns 0 and stays off if nothing was recorded
+    *
+    */
+   uint32_t start_replay();
+
+   /**
+    * stop recording/replaying (the log is kept)
+    *
+    */
+   void stop();
+
+   int mode();
+
+   /**
+    * check whether a session is stored
+    *
+    */
+   int has_log();
+
+   /**
+    * # words used / whether the buffer overflowed
+    *
+    */
+   int words();
+   int overflow();
+
+   /**
+    * record a consumed input event (MODE_RECORD only)
+    *
+    * @param ev event
+    *
+    */
+   void put_input(const InputEvent &ev);
+
+   /**
+    * record the depth reached by an ai search (MODE_RECORD only)
+    *
+    * @param depth search depth
+    *
+    */
+   void put_ai(int depth);
+
+   /**
+    * next input event of the session (MODE_REPLAY only)
+    *
+    * @param ev pointer to the event returned
+    * @return 1: event returned; 0: log ended or out of step (replay
+    *         stops)
+    *
+    */
+   int get_input(InputEvent *ev);
+
+   /**
+    * next ai search depth of the session (MODE_REPLAY only)
+    *
+    * @return depth; 0: log ended or out of step (replay stops)
+    *
+    */
+   int get_ai();
+
+   /**
+    * send the log over a uart (blocking)
+    *
+    * @param uart pointer to uart core instance
+    * @note frame: 'R' 'L' | # words (16-bit) | words | xor checksum;
+    *       multi-byte fields little-endian
+    *
+    */
+   void dump(UartCore *uart);
+
+private:
+   uint32_t buf[LOG_WORDS];
+   int n_words;
+   int rd;
+   int _mode;
+   int ovf;
+   unsigned long last_ms;   // time of the previous record
+   /* methods */
+   void put(uint32_t w);
+   void put_rec(int type, int code, int value, unsigned long ms);
+   int get_rec(int want, int *code, int *value, unsigned long *ms);
+};
+
+#endif  // _REPLAY_H_INCLUDED
@@ -0,0 +1,35 @@
+/*****************************************************************//**
+ * @file scene.cpp
+ *
+ * @brief implementation of the frame buffer backgrounds
+ *
+ ********************************************************************/
+
+#include "scene.h"
+
+void environmentInit(FrameCore *frame_p) {
+   //background
+   frame_p->clr_screen(0xfff);
+
+   //player platform
+   frame_p->fillRoundRect(-50, 300, 400, 150, 600, 0x092);
+   frame_p->fillRoundRect(-40, 305, 380, 140, 200, 0x0db);
+   frame_p->fillRoundRect(-30, 315, 360, 120, 200, 0x16d);
+
+   //cpu platform
+   frame_p->fillRoundRect(330, 130, 300, 90, 600, 0x092); //416, 47 center
+   frame_p->fillRoundRect(340, 135, 280, 80, 200, 0x0db);
+   frame_p->fillRoundRect(350, 140, 260, 70, 200, 0x16d);
+
+   //bottom text
+   frame_p->fillRect(0, 380, 640, 100, 0x000);
+   frame_p->fillRoundRect(10, 385, 620, 95, 20, 0xfff);
+
+   //player status
+   frame_p->fillRoundRect(400, 240, 240, 140, 20, 0x000);
+   frame_p->fillRoundRect(405, 245, 230, 130, 20, 0xfff);
+
+   //cpu status
+   frame_p->fillRoundRect(3, 40, 240, 80, 20, 0x000);
+   frame_p->fillRoundRect(8, 45, 230, 70, 20, 0xfff);
+}
@@ -0,0 +1,25 @@
+/*****************************************************************//**
+ * @file scene.h
+ *
+ * @brief static backgrounds drawn into the frame buffer
+ *
+ * Description:
+ *  - drawing only (no input, timing or state), so the same code runs
+ *    in the game and in host tools (Host/draw_check.cpp)
+ *
+ *********************************************************************/
+
+#ifndef _SCENE_H_INCLUDED
+#define _SCENE_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * draw the battle background: platforms, text box and status boxes
+ *
+ * @param frame_p pointer to frame buffer core instance
+ *
+ */
+void environmentInit(FrameCore *frame_p);
+
+#endif  // _SCENE_H_INCLUDED
@@ -0,0 +1,151 @@
+/*****************************************************************//**
+ * @file tap_detect.cpp
+ *
+ * @brief implementation of TapDetector class
+ *
+ ********************************************************************/
+
+#include "tap_detect.h"
+
+TapDetector::TapDetector(SpiCore *spi) {
+   _spi = spi;
+   period_us = 1000000 / DEF_RATE;
+   refract_ms = DEF_REFRACT_MS;
+   last_us = 0;
+   set_threshold(DEF_ON_THR, DEF_OFF_THR);
+   set_timing(DEF_DEBOUNCE, DEF_REFRACT_MS);
+   reset();
+}
+
+TapDetector::~TapDetector() {
+}  // not used
+
+int TapDetector::init() {
+   uint8_t cmd[3], id;
+
+   _spi->set_freq(400000);
+   _spi->set_mode(0, 0);
+   // check part id
+   cmd[0] = RD_CMD;
+   cmd[1] = PART_ID_REG;
+   _spi->write_then_read(cmd, 2, &id, 1, 0);
+   // start measurement
+   cmd[0] = WR_CMD;
+   cmd[1] = POWER_CTL_REG;
+   cmd[2] = MEASURE_MODE;
+   _spi->transfer(cmd, 0, 3, 0);
+   reset();
+   last_us = now_us();
+   return ((id == PART_ID) ? 0 : -1);
+}
+
+void TapDetector::set_rate(int hz) {
+   if (hz <= 0)
+      hz = DEF_RATE;
+   period_us = 1000000 / hz;
+   update_refract();
+}
+
+void TapDetector::set_threshold(int on_thr, int off_thr) {
+   if (off_thr >= on_thr)
+      off_thr = on_thr - 1;
+   on_q8 = (int32_t) on_thr << 8;
+   off_q8 = (int32_t) off_thr << 8;
+}
+
+void TapDetector::set_timing(int n, int ms) {
+   debounce = (n < 1) ? 1 : n;
+   refract_ms = ms;
+   update_refract();
+}
+
+void TapDetector::reset() {
+   int i;
+
+   for (i = 0; i < 3; i++) {
+      hp[i] = 0;
+      prev[i] = 0;
+   }
+   primed = 0;
+   mag = 0;
+   above = 0;
+   holdoff = 0;
+   armed = 1;
+}
+
+int32_t TapDetector::magnitude() {
+   return (mag);
+}
+
+/* sample at a fixed rate; resynchronize if the caller fell far behind */
+int TapDetector::poll() {
+   uint8_t cmd[2], buf[3];
+   unsigned long now;
+
+   now = now_us();
+   if ((now - last_us) < period_us)
+      return (0);
+   if ((now - last_us) < 2 * period_us)
+      last_us = last_us + period_us;
+   else
+      last_us = now;
+   // burst read x/y/z in one transaction
+   cmd[0] = RD_CMD;
+   cmd[1] = DATA_REG;
+   _spi->write_then_read(cmd, 2, buf, 3, 0);
+   return (process((int8_t) buf[0], (int8_t) buf[1], (int8_t) buf[2]));
+}
+
+/*
+ * dsp step:
+ *  - high-pass (removes gravity/tilt): y[n] = (1-2^-k)*y[n-1] + x[n]-x[n-1]
+ *  - magnitude: L1 norm |x|+|y|+|z| (no multiply/sqrt)
+ *  - trigger when magnitude stays above on level for "debounce" samples;
+ *    re-arm only after it drops below off level and holdoff expires
+ */
+int TapDetector::process(int8_t x, int8_t y, int8_t z) {
+   int8_t in[3];
+   int32_t m;
+   int i, tap;
+
+   in[0] = x;
+   in[1] = y;
+   in[2] = z;
+   if (!primed) {
+      // first sample sets the baseline; no step response
+      for (i = 0; i < 3; i++)
+         prev[i] = in[i];
+      primed = 1;
+   }
+   m = 0;
+   for (i = 0; i < 3; i++) {
+      hp[i] = hp[i] - (hp[i] >> HP_SHIFT) + ((int32_t) (in[i] - prev[i]) << 8);
+      prev[i] = in[i];
+      m = m + ((hp[i] < 0) ? -hp[i] : hp[i]);
+   }
+   mag = m;
+   tap = 0;
+   if (holdoff > 0)
+      holdoff--;
+   if (armed) {
+      if (m >= on_q8) {
+         above++;
+         if (above >= debounce && holdoff == 0) {
+            tap = 1;
+            armed = 0;
+            holdoff = refract_n;
+         }
+      } else {
+         above = 0;
+      }
+   } else if (m < off_q8) {
+      armed = 1;
+      above = 0;
+   }
+   return (tap);
+}
+
+// refractory time in # samples; division only on reconfiguration
+void TapDetector::update_refract() {
+   refract_n = (int) ((unsigned long) refract_ms * 1000 / period_us);
+}
@@ -0,0 +1,153 @@
+/*****************************************************************//**
+ * @file tap_detect.h
+ *
+ * @brief detect taps on the board from ADXL362 accelerometer readings
+ *
+ * Description:
+ *  - integer motion pipeline: high-pass filter, magnitude,
+ *    debounced threshold with hysteresis and refractory time
+ *  - all math in integer/Q8 format (no soft-float on MCS)
+ *  - poll() is a periodic task; it samples the accelerometer
+ *    at the configured rate and returns discrete tap events
+ *  - process() is the pure dsp step; it has no i/o and can be
+ *    fed with recorded x/y/z traces
+ *
+ *********************************************************************/
+
+#ifndef _TAP_DETECT_H_INCLUDED
+#define _TAP_DETECT_H_INCLUDED
+
+#include "chu_init.h"
+#include "spi_core.h"
+
+/**
+ * tap detector
+ *  - ADXL362 connected to spi slave select 0
+ *  - 8-bit x/y/z readings at +/-2g (64 LSB per g)
+ *
+ */
+class TapDetector {
+public:
+   /**
+    * ADXL362 commands and registers
+    *
+    */
+   enum {
+      WR_CMD = 0x0a,        /**< write register command */
+      RD_CMD = 0x0b,        /**< read register command */
+      PART_ID_REG = 0x02,   /**< part id register */
+      DATA_REG = 0x08,      /**< 8-bit x data register (y/z follow) */
+      POWER_CTL_REG = 0x2d  /**< power control register */
+   };
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      PART_ID = 0xf2,       /**< ADXL362 part id */
+      MEASURE_MODE = 0x02,  /**< power_ctl measurement mode */
+      LSB_PER_G = 64,       /**< 8-bit reading at +/-2g */
+      HP_SHIFT = 3,         /**< high-pass pole = 1 - 2^-HP_SHIFT */
+      DEF_RATE = 100,       /**< default sample rate in Hz */
+      DEF_ON_THR = 32,      /**< default trigger level (0.5 g; L1 norm) */
+      DEF_OFF_THR = 16,     /**< default re-arm level (0.25 g; L1 norm) */
+      DEF_DEBOUNCE = 2,     /**< default # samples above trigger level */
+      DEF_REFRACT_MS = 300  /**< default refractory time in ms */
+   };
+
+   /**
+    * constructor
+    *
+    * @param spi pointer to spi core instance
+    *
+    */
+   TapDetector(SpiCore *spi);
+   ~TapDetector();  // not used
+
+   /**
+    * configure spi and put ADXL362 into measurement mode
+    *
+    * @return 0: ok; -1: part id mismatch
+    *
+    */
+   int init();
+
+   /**
+    * set sample rate
+    *
+    * @param hz sample rate in Hz
+    *
+    */
+   void set_rate(int hz);
+
+   /**
+    * set trigger and re-arm levels (hysteresis)
+    *
+    * @param on_thr trigger level in LSB (L1 norm of filtered x/y/z)
+    * @param off_thr re-arm level in LSB (must be below on_thr)
+    *
+    */
+   void set_threshold(int on_thr, int off_thr);
+
+   /**
+    * set debounce count and refractory time
+    *
+    * @param n # consecutive samples above trigger level
+    * @param ms dead time after a tap in ms
+    *
+    */
+   void set_timing(int n, int ms);
+
+   /**
+    * periodic task; sample the accelerometer when the period elapses
+    *
+    * @return 1: tap detected; 0: otherwise
+    *
+    */
+   int poll();
+
+   /**
+    * process one x/y/z sample (pure dsp step; no i/o)
+    *
+    * @param x raw x reading
+    * @param y raw y reading
+    * @param z raw z reading
+    * @return 1: tap detected; 0: otherwise
+    *
+    */
+   int process(int8_t x, int8_t y, int8_t z);
+
+   /**
+    * clear filter and detector state
+    *
+    */
+   void reset();
+
+   /**
+    * magnitude of the last processed sample
+    *
+    * @return L1 norm of filtered x/y/z in Q8 LSB
+    *
+    */
+   int32_t magnitude();
+
+private:
+   SpiCore *_spi;
+   /* sample timing */
+   unsigned long period_us;
+   unsigned long last_us;
+   /* high-pass filter state (Q8) */
+   int32_t hp[3];
+   int8_t prev[3];
+   int primed;
+   /* detector state */
+   int32_t mag;
+   int32_t on_q8, off_q8;
+   int debounce, above;
+   int refract_ms, refract_n, holdoff;
+   int armed;
+   /* methods */
+   void update_refract();
+};
+
+#endif  // _TAP_DETECT_H_INCLUDED
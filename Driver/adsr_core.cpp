@@ -57,6 +57,10 @@ void AdsrCore::bypass() {
 }
 
 void AdsrCore::set_env(int attack_ms, int decay_ms, int sustain_ms, int release_ms, float sus_level) {
+   set_env(attack_ms, decay_ms, sustain_ms, release_ms, q2_14_t::from_double(sus_level));
+}
+
+void AdsrCore::set_env(int attack_ms, int decay_ms, int sustain_ms, int release_ms, q2_14_t sus_level) {
    ams = attack_ms;
    dms = decay_ms;
    sms = sustain_ms;
@@ -67,15 +71,19 @@ void AdsrCore::set_env(int attack_ms, int decay_ms, int sustain_ms, int release_
 
 
 void AdsrCore::select_env(int n) {
+   // sustain levels folded to Q2.14 at compile time
+   constexpr q2_14_t LEVEL_HI = q2_14_t::from_double(0.9);
+   constexpr q2_14_t LEVEL_LO = q2_14_t::from_double(0.1);
+
    switch (n) {
    case 1:
-      set_env(100, 50, 100, 50, 0.9);
+      set_env(100, 50, 100, 50, LEVEL_HI);
       break;
    case 2:
-      set_env(10, 50, 100, 100, 0.9);
+      set_env(10, 50, 100, 100, LEVEL_HI);
       break;
    default:
-      set_env(10, 200, 100, 100, 0.1);
+      set_env(10, 200, 100, 100, LEVEL_LO);
       break;
    }
    return;
@@ -83,10 +91,8 @@ void AdsrCore::select_env(int n) {
 
 void AdsrCore::play_note(int note, int oct, int dur) {
    int sus_tmp;
-   int freq;
 
-   freq = calc_note_freq(oct, note);
-   _ddfs->set_carrier_freq(freq);
+   _ddfs->set_carrier_fcw(DdfsCore::MIDI_C0 + 12 * oct + note);
 
    sus_tmp = dur - (ams + dms + rms);
    if (sus_tmp <= 0) {
@@ -101,25 +107,7 @@ void AdsrCore::play_note(int note, int oct, int dur) {
 
 
 int AdsrCore::calc_note_freq(int oct, int ni) {
-   // frequency table for octave 0
-   const float NOTES[] = { 16.3516,   //  0 C
-         17.3239,   //  1 C#
-         18.3541,   //  2 D
-         19.4454,   //  3 D#
-         20.6017,   //  4 E
-         21.8268,   //  5 F
-         23.1247,   //  6 F#
-         24.4997,   //  7 G
-         25.9565,   //  8 G#
-         27.5000,   //  9 A
-         29.1352,   // 10 A#
-         30.8677    // 11 B
-         };
-   int freq;
-
-   // frequency in octave i: (f in oct 0)*2^i
-   freq = (unsigned int) NOTES[ni] * (1 << oct);
-   return (freq);
+   return (DdfsCore::note_freq(DdfsCore::MIDI_C0 + 12 * oct + ni));
 }
 
 void AdsrCore::write_adsr_reg() {
@@ -136,8 +124,13 @@ void AdsrCore::write_adsr_reg() {
       return;
    }
 
-   // convert sustain level in absolute value
-   sus_abs = (unsigned int) MAX * slevel;
+   // convert sustain level (Q2.14) in absolute value
+   if (slevel.raw() <= 0)
+      sus_abs = 0;
+   else if (slevel.raw() >= (1 << 14))
+      sus_abs = MAX;
+   else
+      sus_abs = (uint32_t) (((uint64_t) MAX * (uint32_t) slevel.raw()) >> 14);
    io_write(base_addr, SUS_LEVEL_REG, (uint32_t )sus_abs);
    // convert attack time (in ms) into envelope increment step
    nc = ams * clks;
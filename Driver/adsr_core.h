@@ -96,6 +96,18 @@ public:
     */
    void set_env(int attack_ms, int decay_ms, int sustain_ms, int release_ms, float sus_level);
 
+   /**
+    * set adsr envelope parameters with a fixed-point sustain level
+    *
+    * @param attack_ms attack time in ms (0 for stop, 0xffffffff for bypass)
+    * @param decay_ms decay time in ms (must be larger than 0)
+    * @param sustain_ms sustain time in ms
+    * @param release_ms release time in ms (must be larger than 0)
+    * @param sus_level sustain level in Q2.14 (0.0 to 1.0 of max value)
+    *
+    */
+   void set_env(int attack_ms, int decay_ms, int sustain_ms, int release_ms, q2_14_t sus_level);
+
    /**
     * select a predefined envelope
     *
@@ -111,7 +123,8 @@ public:
     * @param oct octave #
     * @param ni note (0 to 11 for C, C#, D, ..., B)
     *
-    * @return frequency of the note
+    * @return frequency of the note (rounded)
+    * @note looked up in the compile-time MIDI note table
     */
    int calc_note_freq(int oct, int ni);
 
@@ -124,6 +137,7 @@ public:
     *
     * @note dur determines the length of sustain segment;
     *       sus = dur - (ams + dms + rms);
+    * @note pitch set with one table lookup (DdfsCore::set_carrier_fcw())
     */
    void play_note(int note, int oct, int dur);
 
@@ -132,7 +146,7 @@ private:
    uint32_t base_addr;
    /* current envelope parameters  */
    int ams, dms, sms, rms;
-   float slevel;
+   q2_14_t slevel;
    /* DDFS instance */
    DdfsCore *_ddfs;
    /* method */
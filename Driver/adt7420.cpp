@@ -0,0 +1,97 @@
+/*****************************************************************//**
+ * @file adt7420.cpp
+ *
+ * @brief implementation of Adt7420 class
+ *
+ ********************************************************************/
+
+#include "adt7420.h"
+
+Adt7420::Adt7420(I2cCore *i2c) {
+   int i;
+
+   _i2c = i2c;
+   period_ms = DEF_PERIOD_MS;
+   last_ms = 0;
+   pending = 0;
+   for (i = 0; i < AVG_LEN; i++)
+      ring[i] = 0;
+   sum = 0;
+   idx = 0;
+   last = 0;
+   n_samples = 0;
+   n_errors = 0;
+}
+
+Adt7420::~Adt7420() {
+}  // not used
+
+int Adt7420::init() {
+   uint8_t id;
+
+   if (_i2c->read_regs(DEV_ADDR, ID_REG, &id, 1) != 0)
+      return (-1);
+   last_ms = now_ms();
+   return ((id == ID) ? 0 : -1);
+}
+
+void Adt7420::set_period(int ms) {
+   period_ms = (ms > 0) ? ms : DEF_PERIOD_MS;
+}
+
+void Adt7420::update() {
+   int status;
+   unsigned long now;
+
+   if (pending) {
+      status = _i2c->poll();
+      if (status == I2cCore::I2C_BUSY)
+         return;
+      pending = 0;
+      if (status == I2cCore::I2C_OK)
+         store((int16_t) ((rx[0] << 8) | (rx[1] & 0xf8)));  // 3 LSBs are flags
+      else
+         n_errors++;
+      return;
+   }
+   now = now_ms();
+   if ((now - last_ms) < period_ms || _i2c->busy())
+      return;
+   last_ms = now;
+   if (_i2c->start_read_regs(DEV_ADDR, TEMP_MSB_REG, rx, 2) == I2cCore::I2C_BUSY)
+      pending = 1;
+}
+
+// 1/128 C per LSB -> Q16.16: shift left by 16-7
+q16_16_t Adt7420::latest() {
+   return (q16_16_t::from_raw((int32_t) last << 9));
+}
+
+q16_16_t Adt7420::average() {
+   return (q16_16_t::from_raw((sum << 9) >> AVG_BITS));
+}
+
+uint32_t Adt7420::count() {
+   return (n_samples);
+}
+
+uint32_t Adt7420::errors() {
+   return (n_errors);
+}
+
+/* running sum over the ring; first sample fills the whole ring */
+void Adt7420::store(int16_t raw) {
+   int i;
+
+   if (n_samples == 0) {
+      for (i = 0; i < AVG_LEN; i++)
+         ring[i] = raw;
+      sum = (int32_t) raw << AVG_BITS;
+   } else {
+      sum = sum - ring[idx] + raw;
+      ring[idx] = raw;
+      idx = (idx + 1) & (AVG_LEN - 1);
+   }
+   last = raw;
+   n_samples++;
+}
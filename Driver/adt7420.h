@@ -0,0 +1,129 @@
+/*****************************************************************//**
+ * @file adt7420.h
+ *
+ * @brief sample ADT7420 temperature sensor in background via i2c
+ *
+ * Description:
+ *  - ADT7420 on Nexys A7 i2c bus (device id 0x4b)
+ *  - 13-bit temperature reading (0.0625 C per LSB)
+ *  - update() is a periodic task; it starts a non-blocking
+ *    register read when the sample period elapses and collects
+ *    the result on later calls
+ *  - latest value and moving average kept in Q16.16
+ *
+ *********************************************************************/
+
+#ifndef _ADT7420_H_INCLUDED
+#define _ADT7420_H_INCLUDED
+
+#include "chu_init.h"
+#include "chu_fixed.h"
+#include "i2c_core.h"
+
+/**
+ * ADT7420 temperature sensor driver
+ *  - the i2c core can be shared; a sample is only started
+ *    when no other non-blocking access is in progress
+ *
+ */
+class Adt7420 {
+public:
+   /**
+    * device id and register map
+    *
+    */
+   enum {
+      DEV_ADDR = 0x4b,     /**< i2c device id on Nexys A7 */
+      TEMP_MSB_REG = 0x00, /**< temperature msb (lsb follows) */
+      ID_REG = 0x0b,       /**< id register */
+      ID = 0xcb            /**< manufacturer/revision id */
+   };
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      AVG_BITS = 3,             /**< moving average over 2^AVG_BITS samples */
+      AVG_LEN = 1 << AVG_BITS,  /**< # samples in moving average */
+      DEF_PERIOD_MS = 1000      /**< default sample period */
+   };
+
+   /**
+    * constructor
+    *
+    * @param i2c pointer to i2c core instance
+    *
+    */
+   Adt7420(I2cCore *i2c);
+   ~Adt7420();  // not used
+
+   /**
+    * check device id (blocking; call once at boot)
+    *
+    * @return 0: ok; -1: no device or wrong id
+    *
+    */
+   int init();
+
+   /**
+    * set sample period
+    *
+    * @param ms sample period in ms
+    *
+    */
+   void set_period(int ms);
+
+   /**
+    * periodic task; start or complete a background sample
+    *
+    * @note never waits on the i2c bus
+    */
+   void update();
+
+   /**
+    * latest temperature
+    *
+    * @return temperature in Celsius in Q16.16
+    *
+    */
+   q16_16_t latest();
+
+   /**
+    * moving average of temperature
+    *
+    * @return average temperature in Celsius in Q16.16
+    *
+    */
+   q16_16_t average();
+
+   /**
+    * number of samples taken
+    *
+    * @return # samples (0: no valid reading yet)
+    *
+    */
+   uint32_t count();
+
+   /**
+    * number of failed samples (no ack)
+    *
+    */
+   uint32_t errors();
+
+private:
+   I2cCore *_i2c;
+   unsigned long period_ms;
+   unsigned long last_ms;
+   int pending;
+   uint8_t rx[2];
+   /* samples in 1/128 C (13-bit reading left-justified in 16 bits) */
+   int16_t ring[AVG_LEN];
+   int32_t sum;
+   int idx;
+   int16_t last;
+   uint32_t n_samples, n_errors;
+   /* methods */
+   void store(int16_t raw);
+};
+
+#endif  // _ADT7420_H_INCLUDED
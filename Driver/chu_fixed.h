@@ -0,0 +1,266 @@
+/*****************************************************************//**
+ * @file chu_fixed.h
+ *
+ * @brief header-only Qm.n fixed-point type and helpers
+ *
+ * Description:
+ *  - Fixed<M, N>: signed Qm.n number in a 32-bit word
+ *    (M integer bits including sign, N fraction bits, M+N <= 32)
+ *  - arithmetic saturates to the Qm.n range
+ *  - all operations are constexpr; constants such as
+ *    Fixed<2,14>::from_double(0.9) are folded at compile time,
+ *    so no soft-float code is pulled in at run time
+ *  - URecip replaces division by a run-time constant with
+ *    a multiply and a shift
+ *
+ *********************************************************************/
+
+#ifndef _CHU_FIXED_H_INCLUDED
+#define _CHU_FIXED_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * signed Qm.n fixed-point number
+ *
+ * @tparam M # integer bits (including sign bit)
+ * @tparam N # fraction bits
+ *
+ */
+template <int M, int N>
+class Fixed {
+   static_assert(M >= 1 && N >= 1 && M + N <= 32, "Qm.n must fit in 32 bits");
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      INT_BITS = M,   /**< # integer bits (including sign) */
+      FRAC_BITS = N   /**< # fraction bits */
+   };
+
+   /**
+    * constructor (value 0)
+    *
+    */
+   constexpr Fixed() : r(0) {
+   }
+
+   /**
+    * largest raw value of Qm.n
+    *
+    */
+   static constexpr int32_t max_raw() {
+      return ((int32_t) (((int64_t) 1 << (M + N - 1)) - 1));
+   }
+
+   /**
+    * smallest raw value of Qm.n
+    *
+    */
+   static constexpr int32_t min_raw() {
+      return (-max_raw() - 1);
+   }
+
+   /**
+    * clamp a wide intermediate result to the Qm.n range
+    *
+    * @param v raw value in 64-bit
+    * @return saturated raw value
+    */
+   static constexpr int32_t sat(int64_t v) {
+      return ((v > max_raw()) ? max_raw() : ((v < min_raw()) ? min_raw() : (int32_t) v));
+   }
+
+   /**
+    * create from raw (already scaled) bits
+    *
+    * @param raw raw value (value * 2^N)
+    */
+   static constexpr Fixed from_raw(int32_t raw) {
+      return (Fixed(sat(raw), 0));
+   }
+
+   /**
+    * create from an integer
+    *
+    * @param i integer value
+    */
+   static constexpr Fixed from_int(int32_t i) {
+      return (Fixed(sat((int64_t) i * ((int64_t) 1 << N)), 0));
+   }
+
+   /**
+    * create from a ratio of two integers (num/den)
+    *
+    * @param num numerator
+    * @param den denominator
+    * @note intended for constants; division is done once
+    */
+   static constexpr Fixed ratio(int32_t num, int32_t den) {
+      return (Fixed(sat(((int64_t) num * ((int64_t) 1 << N)) / den), 0));
+   }
+
+   /**
+    * create from a floating-point value (rounded to nearest)
+    *
+    * @param d floating-point value
+    * @note folded at compile time when d is a constant;
+    *       use in constexpr context to avoid soft-float code
+    */
+   static constexpr Fixed from_double(double d) {
+      return (Fixed(sat_d(d * (double) ((int64_t) 1 << N)), 0));
+   }
+
+   /**
+    * raw bits (value * 2^N)
+    *
+    */
+   constexpr int32_t raw() const {
+      return (r);
+   }
+
+   /**
+    * integer part (rounded toward minus infinity)
+    *
+    */
+   constexpr int32_t to_int() const {
+      return (r >> N);
+   }
+
+   /**
+    * value rounded to the nearest integer
+    *
+    */
+   constexpr int32_t round() const {
+      return ((int32_t) (((int64_t) r + ((int64_t) 1 << (N - 1))) >> N));
+   }
+
+   /**
+    * convert to floating point (debugging/host use only)
+    *
+    */
+   constexpr double to_double() const {
+      return ((double) r / (double) ((int64_t) 1 << N));
+   }
+
+   /**
+    * convert to another Q format (with rounding and saturation)
+    *
+    * @tparam M2 # integer bits of the target format
+    * @tparam N2 # fraction bits of the target format
+    */
+   template <int M2, int N2>
+   constexpr Fixed<M2, N2> convert() const {
+      return (Fixed<M2, N2>::from_raw64(rescale(r, N, N2)));
+   }
+
+   /**
+    * scale an integer by this value (i * value, rounded)
+    *
+    * @param i integer operand
+    * @return product as a plain integer (not saturated to Qm.n)
+    */
+   constexpr int32_t scale(int32_t i) const {
+      return ((int32_t) (((int64_t) i * r + ((int64_t) 1 << (N - 1))) >> N));
+   }
+
+   /* saturating arithmetic */
+   constexpr Fixed operator+(Fixed b) const {
+      return (Fixed(sat((int64_t) r + b.r), 0));
+   }
+   constexpr Fixed operator-(Fixed b) const {
+      return (Fixed(sat((int64_t) r - b.r), 0));
+   }
+   constexpr Fixed operator-() const {
+      return (Fixed(sat(-(int64_t) r), 0));
+   }
+   constexpr Fixed operator*(Fixed b) const {
+      return (Fixed(sat(((int64_t) r * b.r + ((int64_t) 1 << (N - 1))) >> N), 0));
+   }
+   constexpr Fixed operator*(int32_t i) const {
+      return (Fixed(sat((int64_t) r * i), 0));
+   }
+   constexpr Fixed operator>>(int s) const {
+      return (Fixed(r >> s, 0));
+   }
+   Fixed &operator+=(Fixed b) {
+      r = sat((int64_t) r + b.r);
+      return (*this);
+   }
+   Fixed &operator-=(Fixed b) {
+      r = sat((int64_t) r - b.r);
+      return (*this);
+   }
+
+   /* comparison */
+   constexpr bool operator==(Fixed b) const { return (r == b.r); }
+   constexpr bool operator!=(Fixed b) const { return (r != b.r); }
+   constexpr bool operator<(Fixed b) const { return (r < b.r); }
+   constexpr bool operator<=(Fixed b) const { return (r <= b.r); }
+   constexpr bool operator>(Fixed b) const { return (r > b.r); }
+   constexpr bool operator>=(Fixed b) const { return (r >= b.r); }
+
+   /**
+    * create from a 64-bit raw value (saturated)
+    *
+    * @param raw raw value (value * 2^N)
+    */
+   static constexpr Fixed from_raw64(int64_t raw) {
+      return (Fixed(sat(raw), 0));
+   }
+
+private:
+   int32_t r;   // raw bits
+   constexpr Fixed(int32_t raw, int) : r(raw) {
+   }
+   static constexpr int32_t sat_d(double v) {
+      return ((v >= (double) max_raw()) ? max_raw() :
+              ((v <= (double) min_raw()) ? min_raw() :
+               (int32_t) ((v < 0.0) ? (v - 0.5) : (v + 0.5))));
+   }
+   static constexpr int64_t rescale(int64_t v, int from, int to) {
+      return ((to >= from) ? (v * ((int64_t) 1 << (to - from))) :
+              ((v + ((int64_t) 1 << (from - to - 1))) >> (from - to)));
+   }
+};
+
+/* commonly used formats */
+typedef Fixed<2, 14> q2_14_t;     /**< 16-bit; ddfs envelope, levels 0.0-1.0 */
+typedef Fixed<1, 15> q1_15_t;     /**< 16-bit; audio samples/gains */
+typedef Fixed<16, 16> q16_16_t;   /**< 32-bit; general purpose */
+
+/**
+ * unsigned division by a run-time constant
+ *  - d is converted once into a 32-bit reciprocal
+ *  - div(x) = (x * ceil(2^32/d)) >> 32
+ *  - exact for x < 2^16 and d < 2^16 (x*d < 2^32)
+ *
+ */
+class URecip {
+public:
+   /**
+    * constructor
+    *
+    * @param d divisor (1 to 65535)
+    */
+   constexpr URecip(uint32_t d) :
+         m((d <= 1) ? 0 : (uint32_t) ((((uint64_t) 1 << 32) + d - 1) / d)), one(d <= 1) {
+   }
+
+   /**
+    * quotient x/d
+    *
+    * @param x dividend (below 2^16 for an exact result)
+    */
+   constexpr uint32_t div(uint32_t x) const {
+      return (one ? x : (uint32_t) (((uint64_t) x * m) >> 32));
+   }
+
+private:
+   uint32_t m;   // ceil(2^32/d)
+   bool one;     // d == 1 (reciprocal does not fit in 32 bits)
+};
+
+#endif  // _CHU_FIXED_H_INCLUDED
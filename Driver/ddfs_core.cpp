@@ -9,6 +9,54 @@
 
 #include "ddfs_core.h"
 
+// 2^(PHA_WIDTH+32)/f_sys, rounded; fcw = (freq * FCW_RECIP) >> 32
+static const uint64_t FCW_RECIP =
+      ((((uint64_t) 1 << (DdfsCore::PHA_WIDTH + 32)) + (SYS_CLK_FREQ * 1000000ULL / 2))
+            / (SYS_CLK_FREQ * 1000000ULL));
+
+/**********************************************************************
+ * MIDI note tables (evaluated at compile time)
+ *  - f(n) = 440 * 2^((n-69)/12)
+ *  - fcw(n) = f(n) * 2^PHA_WIDTH / f_sys
+ *********************************************************************/
+namespace {
+
+// 2^(i/12) for i = 0 to 11
+constexpr double SEMITONE[12] = {
+      1.0, 1.0594630943592953, 1.1224620483093730, 1.1892071150027210,
+      1.2599210498948732, 1.3348398541700344, 1.4142135623730951,
+      1.4983070768766815, 1.5874010519681994, 1.6817928305074290,
+      1.7817974362806785, 1.8877486253633868 };
+
+constexpr double note_hz(int n) {
+   // n-69 = 12*k + r with 0 <= r < 12 (n >= 0)
+   double f = 440.0 * SEMITONE[(n + 3) % 12];
+   int k = (n + 3) / 12 - 6;
+
+   for (; k > 0; k--)
+      f = f * 2.0;
+   for (; k < 0; k++)
+      f = f * 0.5;
+   return (f);
+}
+
+struct NoteTable {
+   uint32_t fcw[DdfsCore::N_NOTES];
+   uint16_t hz[DdfsCore::N_NOTES];
+   constexpr NoteTable() : fcw(), hz() {
+      for (int n = 0; n < DdfsCore::N_NOTES; n++) {
+         double f = note_hz(n);
+         fcw[n] = (uint32_t) (f * (double) (1UL << DdfsCore::PHA_WIDTH)
+               / (SYS_CLK_FREQ * 1000000.0) + 0.5);
+         hz[n] = (uint16_t) (f + 0.5);
+      }
+   }
+};
+
+constexpr NoteTable NOTE_TABLE;
+
+}  // namespace
+
 DdfsCore::DdfsCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
    init();
@@ -27,27 +75,45 @@ void DdfsCore::init() {
    set_carrier_freq(262);
    set_offset_freq(0);
    set_phase_degree(0);
-   set_env(1.0);
+   set_env(q2_14_t::from_int(1));
+}
+
+// convert frequency to control word: freq*2^PHA_WIDTH/f_sys (rounded)
+uint32_t DdfsCore::freq2cw(int freq) {
+   uint64_t mag;
+   uint32_t cw;
+
+   mag = (uint64_t) ((freq < 0) ? -freq : freq);
+   cw = (uint32_t) ((mag * FCW_RECIP + 0x80000000ULL) >> 32);
+   return ((freq < 0) ? (uint32_t) (-(int32_t) cw) : cw);
 }
 
 void DdfsCore::set_carrier_freq(int freq) {
-   uint32_t fcw, p2n;
-   float tmp;
+   io_write(base_addr, FCW_REG, freq2cw(freq));
+}
 
-   p2n = 1 << PHA_WIDTH;  //2^PHA_WIDTH
-   tmp = ((float) p2n) / float(SYS_CLK_FREQ * 1000000);
-   fcw = uint32_t(freq * tmp);
-   io_write(base_addr, FCW_REG, fcw);
+void DdfsCore::set_carrier_fcw(int note) {
+   io_write(base_addr, FCW_REG, note_fcw(note));
 }
 
-void DdfsCore::set_offset_freq(int freq) {
-   uint32_t fow, p2n;
-   float tmp;
+uint32_t DdfsCore::note_fcw(int note) {
+   if (note < 0)
+      note = 0;
+   if (note >= N_NOTES)
+      note = N_NOTES - 1;
+   return (NOTE_TABLE.fcw[note]);
+}
+
+int DdfsCore::note_freq(int note) {
+   if (note < 0)
+      note = 0;
+   if (note >= N_NOTES)
+      note = N_NOTES - 1;
+   return (NOTE_TABLE.hz[note]);
+}
 
-   p2n = 1 << PHA_WIDTH;  //2^PHA_WIDTH
-   tmp = ((float) p2n) / float(SYS_CLK_FREQ * 1000000);
-   fow = uint32_t(freq * tmp);
-   io_write(base_addr, FOW_REG, fow);
+void DdfsCore::set_offset_freq(int freq) {
+   io_write(base_addr, FOW_REG, freq2cw(freq));
 }
 
 void DdfsCore::set_phase_degree(int phase) {
@@ -62,11 +128,15 @@ void DdfsCore::set_env(float env) {
    int32_t q214;
    float max_amp;
 
-   max_amp = (float) (0x4000);   // 2^15
+   max_amp = (float) (0x4000);   // 2^14
    q214 = (int32_t) (env * max_amp);
    io_write(base_addr, ENV_REG, q214 & 0x0000ffff);
 }
 
+void DdfsCore::set_env(q2_14_t env) {
+   io_write(base_addr, ENV_REG, (uint32_t) env.raw() & 0x0000ffff);
+}
+
 void DdfsCore::set_fow_source(int channel) {
    int ch = 0;
 
@@ -11,6 +11,7 @@
 #define _DDFS_H_INCLUDED
 
 #include "chu_init.h"
+#include "chu_fixed.h"
 
 /**
  * ddfs core driver:
@@ -40,7 +41,9 @@ public:
     *
     */
 	enum {
-		PHA_WIDTH = 30  /**< bits in ddfs phase register */
+		PHA_WIDTH = 30,   /**< bits in ddfs phase register */
+		N_NOTES = 128,    /**< # MIDI notes in fcw table (0 to 127) */
+		MIDI_C0 = 12      /**< MIDI number of C in octave 0 */
 	};
 
 	/* methods */
@@ -63,13 +66,43 @@ public:
 	 *
 	 * @param freq carrier frequency
 	 *
+	 * @note fcw = freq*2^PHA_WIDTH/f_sys computed with a
+	 *       precomputed reciprocal (integer multiply and shift)
 	 */
 	void set_carrier_freq(int freq);
 
+	/**
+	 * set ddfs carrier freq to a MIDI note (fast path)
+	 *
+	 * @param note MIDI note number (0 to 127; 69 is A4 = 440 Hz)
+	 *
+	 * @note fcw taken from a table computed at compile time
+	 *       from SYS_CLK_FREQ and PHA_WIDTH; one MMIO write
+	 */
+	void set_carrier_fcw(int note);
+
+	/**
+	 * frequency control word of a MIDI note
+	 *
+	 * @param note MIDI note number (0 to 127)
+	 * @return fcw (equal temperament, A4 = 440 Hz, rounded)
+	 *
+	 */
+	static uint32_t note_fcw(int note);
+
+	/**
+	 * frequency of a MIDI note
+	 *
+	 * @param note MIDI note number (0 to 127)
+	 * @return frequency in Hz (rounded)
+	 *
+	 */
+	static int note_freq(int note);
+
 	/**
 	 * set ddfs offset (delta) freq
 	 *
-	 * @param freq offset frequency
+	 * @param freq offset frequency (may be negative)
 	 *
 	 */
 	void set_offset_freq(int freq);
@@ -90,6 +123,15 @@ public:
 	 */
 	void set_env(float env);
 
+	/**
+	 * set ddfs envelope (amplitude) in fixed-point format
+	 *
+	 * @param env envelope value in Q2.14 (between -1.0 and 1.0)
+	 *
+	 * @note no floating-point operation involved
+	 */
+	void set_env(q2_14_t env);
+
 	/**
 	 * select fow source
 	 *
@@ -125,6 +167,8 @@ private:
 	/* variable to keep track of current status */
 	uint32_t base_addr;
 	uint32_t ch_select_reg;
+	/* methods */
+	static uint32_t freq2cw(int freq);
 
 };
 
@@ -92,6 +92,10 @@ void PwmCore::set_freq(int freq) {
    io_write(base_addr, DVSR_REG, dvsr);
 }
 
+void PwmCore::set_dvsr(uint32_t dvsr) {
+   io_write(base_addr, DVSR_REG, dvsr);
+}
+
 void PwmCore::set_duty(int duty, int channel) {
    uint32_t d;
 
@@ -110,3 +114,10 @@ void PwmCore::set_duty(double f, int channel) {
    set_duty(duty, channel);
 }
 
+void PwmCore::set_duty(q2_14_t f, int channel) {
+   int duty;
+
+   duty = (f.raw() < 0) ? 0 : f.scale(MAX);
+   set_duty(duty, channel);
+}
+
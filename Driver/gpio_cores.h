@@ -13,6 +13,7 @@
 #define _GPIO_H_INCLUDED
 
 #include "chu_init.h"
+#include "chu_fixed.h"
 
 /**********************************************************************
  * gpi (general-purpose input) core driver
@@ -160,6 +161,16 @@ public:
     */
    void set_freq(int freq);
 
+   /**
+    * set the prescaler directly
+    *
+    * @param dvsr duty counter advances every dvsr+1 clocks
+    * @note switching frequency is f_sys/(dvsr+1)/MAX; dvsr 0 gives
+    *       the fastest carrier, which set_freq() cannot reach
+    *
+    */
+   void set_dvsr(uint32_t dvsr);
+
    /**
     * set duty cycle in unsigned format (between 0 and MAX)
     *
@@ -178,6 +189,15 @@ public:
     */
    void set_duty(double f, int channel);
 
+   /**
+    * set duty cycle in fixed-point format (between 0.0 and 1.0)
+    *
+    * @param f duty cycle % in Q2.14 (between 0.0 and 1.0)
+    * @param channel pwm channel number
+    *
+    */
+   void set_duty(q2_14_t f, int channel);
+
 private:
    uint32_t base_addr;
    uint32_t freq;
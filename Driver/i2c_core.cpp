@@ -12,6 +12,9 @@
 /* methods */
 I2cCore::I2cCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   op_state = OP_IDLE;
+   op_pend = PEND_NONE;
+   op_ack = 0;
    set_freq(100000);  // default 100K Hz
 }
 I2cCore::~I2cCore() {
@@ -123,3 +126,135 @@ int I2cCore::write_transaction(uint8_t dev, uint8_t *bytes, int num,
    }
    return (ack);
 }
+
+int I2cCore::read_regs(uint8_t dev, uint8_t reg, uint8_t *buf, int num) {
+   int status;
+
+   status = start_read_regs(dev, reg, buf, num);
+   while (status == I2C_BUSY) {
+      status = poll();
+   }
+   return (status);
+}
+
+int I2cCore::write_regs(uint8_t dev, uint8_t reg, const uint8_t *buf,
+      int num) {
+   int status;
+
+   status = start_write_regs(dev, reg, buf, num);
+   while (status == I2C_BUSY) {
+      status = poll();
+   }
+   return (status);
+}
+
+int I2cCore::start_read_regs(uint8_t dev, uint8_t reg, uint8_t *buf,
+      int num) {
+   if (busy())
+      return (I2C_IN_USE);   // keep the buffers of the running access
+   op_rx = buf;
+   op_tx = 0;
+   return (start_op(dev, reg, num, 1));
+}
+
+int I2cCore::start_write_regs(uint8_t dev, uint8_t reg, const uint8_t *buf,
+      int num) {
+   if (busy())
+      return (I2C_IN_USE);
+   op_rx = 0;
+   op_tx = buf;
+   return (start_op(dev, reg, num, 0));
+}
+
+int I2cCore::busy() {
+   return (op_state != OP_IDLE);
+}
+
+int I2cCore::start_op(uint8_t dev, uint8_t reg, int num, int read) {
+   if (op_state != OP_IDLE)
+      return (I2C_IN_USE);
+   op_dev = dev;
+   op_reg = reg;
+   op_num = num;
+   op_cnt = 0;
+   op_read = read;
+   op_ack = 0;
+   op_pend = PEND_NONE;
+   op_state = OP_START;
+   return (I2C_BUSY);
+}
+
+/*
+ * one status read per call:
+ *  - the ready word also carries ack/data of the previous command
+ *  - collect that result, then issue the next command
+ */
+int I2cCore::poll() {
+   uint32_t rd_word, cmd;
+
+   if (op_state == OP_IDLE)
+      return (op_ack);
+   rd_word = io_read(base_addr, RD_REG);
+   if (!(rd_word & READY_FIELD))
+      return (I2C_BUSY);
+   // collect result of previous command
+   if (op_pend == PEND_ACK) {
+      if (rd_word & ACK_FIELD)
+         op_ack--;     // slave fails to ack
+   } else if (op_pend == PEND_DATA) {
+      *op_rx = (uint8_t) (rd_word & RX_DATA_FIELD);
+      op_rx++;
+   }
+   op_pend = PEND_NONE;
+   // issue next command
+   switch (op_state) {
+   case OP_START:
+      cmd = I2C_START_CMD;
+      op_state = OP_DEV_WR;
+      break;
+   case OP_DEV_WR:
+      cmd = I2C_WR_CMD | (op_dev << 1);     // LSB=0 for I2c write
+      op_pend = PEND_ACK;
+      op_state = OP_REG;
+      break;
+   case OP_REG:
+      cmd = I2C_WR_CMD | op_reg;
+      op_pend = PEND_ACK;
+      if (op_read)
+         op_state = OP_RESTART;
+      else
+         op_state = (op_num > 0) ? OP_WRITE : OP_STOP;
+      break;
+   case OP_RESTART:
+      cmd = I2C_RESTART_CMD;
+      op_state = OP_DEV_RD;
+      break;
+   case OP_DEV_RD:
+      cmd = I2C_WR_CMD | (op_dev << 1) | 0x01;  // LSB=1 for I2c read
+      op_pend = PEND_ACK;
+      op_state = (op_num > 0) ? OP_READ : OP_STOP;
+      break;
+   case OP_READ:
+      op_cnt++;
+      // last byte in read cycle forces master generating NACK
+      cmd = I2C_RD_CMD | ((op_cnt == op_num) ? 1 : 0);
+      op_pend = PEND_DATA;
+      if (op_cnt == op_num)
+         op_state = OP_STOP;
+      break;
+   case OP_WRITE:
+      cmd = I2C_WR_CMD | *op_tx;
+      op_tx++;
+      op_cnt++;
+      op_pend = PEND_ACK;
+      if (op_cnt == op_num)
+         op_state = OP_STOP;
+      break;
+   default:   // OP_STOP
+      cmd = I2C_STOP_CMD;
+      op_state = OP_IDLE;
+      break;
+   }
+   io_write(base_addr, WR_REG, cmd);
+   return ((op_state == OP_IDLE) ? op_ack : I2C_BUSY);
+}
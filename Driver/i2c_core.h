@@ -7,6 +7,8 @@
  * - 5 basic commands: start, read, write, stop, restart
  * - i2c transaction can be "assembled" with commands
  *   e.g., start, write, write, stop
+ * - register burst read/write (write pointer, restart, burst)
+ * - non-blocking version advanced from the main loop via poll()
  *
  * @author p chu
  * @version v1.0: initial release
@@ -23,6 +25,11 @@
  * - 5 basic i2c commands: start, read, write, stop, restart
  * - i2c transaction can be "assembled" with commands;
  *   e.g., start, write, write, stop
+ * - read_regs()/write_regs() perform a complete register access
+ * - start_read_regs()/start_write_regs() queue the same access;
+ *   poll() issues the next command whenever the core is ready
+ *   and returns immediately otherwise
+ * - blocking and non-blocking accesses must not overlap
  *
  */
 class I2cCore {
@@ -56,6 +63,24 @@ public:
       I2C_STOP_CMD = 0x03 << 8,   /**< stop command */
       I2C_RESTART_CMD = 0x04 << 8 /**< restart command */
    };
+   /**
+    * field masks of read data register
+    *
+    */
+   enum {
+      RX_DATA_FIELD = 0x000000ff, /**< bits 7..0; read data */
+      READY_FIELD = 0x00000100,   /**< bit 8; ready bit */
+      ACK_FIELD = 0x00000200      /**< bit 9; ack bit (0: acknowledged) */
+   };
+   /**
+    * non-blocking access status
+    *
+    */
+   enum {
+      I2C_OK = 0,     /**< access completed; all bytes acknowledged */
+      I2C_BUSY = 1,   /**< access in progress (negative: # failed acks) */
+      I2C_IN_USE = 2  /**< not queued: another access in progress; retry later */
+   };
    /* methods */
    /**
     * constructor
@@ -151,9 +176,111 @@ public:
    int write_transaction(uint8_t dev, uint8_t *bytes, int num,
          int restart);
 
+   /**
+    * read a block of device registers
+    *
+    * @param dev device id
+    * @param reg first register address
+    * @param buf pointer to read data array
+    * @param num number of registers to be read
+    *
+    * @return device ack status (0: ok; negative: # failed acks);
+    *         I2C_IN_USE: a non-blocking access is in progress
+    *         (nothing read, buf unchanged)
+    *
+    * @note command sequence: start, write dev/wr, write reg,
+    *       restart, write dev/rd, read, .., read (nack), stop
+    *
+    */
+   int read_regs(uint8_t dev, uint8_t reg, uint8_t *buf, int num);
+
+   /**
+    * write a block of device registers
+    *
+    * @param dev device id
+    * @param reg first register address
+    * @param buf pointer to write data array
+    * @param num number of registers to be written
+    *
+    * @return device ack status (0: ok; negative: # failed acks);
+    *         I2C_IN_USE: a non-blocking access is in progress
+    *         (nothing written)
+    *
+    * @note command sequence: start, write dev/wr, write reg,
+    *       write, .., write, stop
+    *
+    */
+   int write_regs(uint8_t dev, uint8_t reg, const uint8_t *buf, int num);
+
+   /**
+    * start a non-blocking register block read
+    *
+    * @param dev device id
+    * @param reg first register address
+    * @param buf pointer to read data array (must stay valid until done)
+    * @param num number of registers to be read
+    *
+    * @return I2C_BUSY if queued; I2C_IN_USE if another access is in
+    *         progress (nothing queued)
+    *
+    */
+   int start_read_regs(uint8_t dev, uint8_t reg, uint8_t *buf, int num);
+
+   /**
+    * start a non-blocking register block write
+    *
+    * @param dev device id
+    * @param reg first register address
+    * @param buf pointer to write data array (must stay valid until done)
+    * @param num number of registers to be written
+    *
+    * @return I2C_BUSY if queued; I2C_IN_USE if another access is in
+    *         progress (nothing queued)
+    *
+    */
+   int start_write_regs(uint8_t dev, uint8_t reg, const uint8_t *buf,
+         int num);
+
+   /**
+    * advance the non-blocking access
+    *
+    * @return I2C_BUSY: in progress; I2C_OK: done;
+    *         negative: done with # failed acks
+    *
+    * @note issues at most one command per call (the core is busy
+    *       right after a command); one status read per call
+    */
+   int poll();
+
+   /**
+    * check whether a non-blocking access is in progress
+    *
+    * @return 1: in progress; 0: otherwise
+    *
+    */
+   int busy();
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
+   /* non-blocking access state */
+   enum {
+      OP_IDLE, OP_START, OP_DEV_WR, OP_REG, OP_RESTART, OP_DEV_RD,
+      OP_READ, OP_WRITE, OP_STOP
+   };
+   enum {
+      PEND_NONE, PEND_ACK, PEND_DATA
+   };
+   int op_state;       // next command to issue
+   int op_pend;        // result of last command to be collected
+   int op_ack;         // # failed acks (negative)
+   int op_read;        // 1: read access; 0: write access
+   uint8_t op_dev, op_reg;
+   uint8_t *op_rx;
+   const uint8_t *op_tx;
+   int op_num, op_cnt;
+   /* methods */
+   int start_op(uint8_t dev, uint8_t reg, int num, int read);
 
 };
 
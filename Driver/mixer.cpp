@@ -0,0 +1,219 @@
+/*****************************************************************//**
+ * @file mixer.cpp
+ *
+ * @brief implementation of Mixer class
+ *
+ ********************************************************************/
+
+#include "mixer.h"
+#include "ddfs_core.h"
+
+/**********************************************************************
+ * wavetables (evaluated at compile time)
+ *  - one period in TBL_LEN 8-bit samples, amplitude +/-127
+ *  - sine: Taylor series on the first quarter, mirrored
+ *********************************************************************/
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// sin(x) for 0 <= x <= pi/2
+constexpr double quarter_sin(double x) {
+   double term = x, sum = x;
+
+   for (int k = 1; k < 12; k++) {
+      term = -term * x * x / (double) ((2 * k) * (2 * k + 1));
+      sum = sum + term;
+   }
+   return (sum);
+}
+
+constexpr int8_t round_q7(double v) {
+   return ((int8_t) ((v < 0.0) ? (v * 127.0 - 0.5) : (v * 127.0 + 0.5)));
+}
+
+struct WaveTable {
+   int8_t w[Mixer::N_WAVES][Mixer::TBL_LEN];
+   constexpr WaveTable() : w() {
+      const int n = Mixer::TBL_LEN;
+      for (int i = 0; i < n; i++) {
+         // fold index into first quarter: sin(pi-x) = sin(x), sin(-x) = -sin(x)
+         int q = i % (n / 2);
+         if (q > n / 4)
+            q = n / 2 - q;
+         double s = quarter_sin(2.0 * PI * q / n);
+         w[Mixer::WAVE_SINE][i] = round_q7((i < n / 2) ? s : -s);
+         // triangle: 0 -> +1 -> -1 -> 0
+         int t = (i < n / 4) ? i : ((i < 3 * n / 4) ? (n / 2 - i) : (i - n));
+         w[Mixer::WAVE_TRI][i] = round_q7((double) t / (n / 4));
+         w[Mixer::WAVE_SAW][i] = round_q7((double) (i - n / 2) / (n / 2));
+         w[Mixer::WAVE_SQUARE][i] = (i < n / 2) ? 127 : -127;
+      }
+   }
+};
+
+constexpr WaveTable WAVE_TABLE;
+
+}  // namespace
+
+Mixer::Mixer(PwmCore *pwm, int channel) {
+   _pwm = pwm;
+   ch = channel;
+   gain = DEF_GAIN;
+   for (int i = 0; i < N_VOICES; i++) {
+      voice[i].tbl = WAVE_TABLE.w[WAVE_SINE];
+      voice[i].phase = 0;
+      voice[i].step = 0;
+      voice[i].vol = 0;
+      voice[i].left = 0;
+   }
+   step_per_hz = 0;
+   samples_per_ms = 0;
+   period_q4 = 0;
+   next_q4 = 0;
+   n_late = 0;
+}
+
+Mixer::~Mixer() {
+}  // not used
+
+// divisions done once here, not per sample
+void Mixer::init(int rate) {
+   if (rate <= 0)
+      rate = DEF_RATE;
+   // fastest carrier: prescaler 0, pwm counter advances every clock
+   _pwm->set_dvsr(0);
+   _pwm->set_duty(PwmCore::MAX / 2, ch);
+   step_per_hz = (uint32_t) ((((uint64_t) 1 << 32) + rate / 2) / rate);
+   samples_per_ms = (uint32_t) (rate / 1000);
+   period_q4 = 16000000UL / (unsigned long) rate;
+   for (int i = 0; i < N_VOICES; i++)
+      note_off(i);
+   n_late = 0;
+   next_q4 = now_us() * 16 + period_q4;
+}
+
+void Mixer::set_gain(int shift) {
+   gain = (shift < 0) ? 0 : shift;
+}
+
+void Mixer::note_on(int voice_n, int note, int wave, int vol, int ms) {
+   Voice *v;
+
+   if (voice_n < 0 || voice_n >= N_VOICES)
+      return;
+   if (wave < 0 || wave >= N_WAVES)
+      wave = WAVE_SINE;
+   v = &voice[voice_n];
+   v->vol = 0;    // mute while the voice is rewritten
+   v->tbl = WAVE_TABLE.w[wave];
+   v->phase = 0;
+   v->left = (ms == HOLD) ? HOLD : (int32_t) (ms * samples_per_ms);
+   set_freq(voice_n, DdfsCore::note_freq(note));
+   set_vol(voice_n, vol);
+}
+
+int Mixer::play(int note, int wave, int vol, int ms) {
+   int i, best;
+
+   // free voice first; otherwise steal the one closest to its end
+   best = 0;
+   for (i = 0; i < N_VOICES; i++) {
+      if (voice[i].vol == 0) {
+         best = i;
+         break;
+      }
+      if (voice[i].left != HOLD
+            && (voice[best].left == HOLD || voice[i].left < voice[best].left))
+         best = i;
+   }
+   note_on(best, note, wave, vol, ms);
+   return (best);
+}
+
+void Mixer::note_off(int voice_n) {
+   if (voice_n < 0 || voice_n >= N_VOICES)
+      return;
+   voice[voice_n].vol = 0;
+}
+
+void Mixer::set_freq(int voice_n, int hz) {
+   if (voice_n < 0 || voice_n >= N_VOICES)
+      return;
+   voice[voice_n].step = (uint32_t) hz * step_per_hz;
+}
+
+void Mixer::set_vol(int voice_n, int vol) {
+   if (voice_n < 0 || voice_n >= N_VOICES)
+      return;
+   if (vol > 255)
+      vol = 255;
+   if (vol < 0)
+      vol = 0;
+   voice[voice_n].vol = vol;
+}
+
+int Mixer::active(int voice_n) {
+   if (voice_n < 0 || voice_n >= N_VOICES)
+      return (0);
+   return (voice[voice_n].vol != 0);
+}
+
+unsigned long Mixer::late() {
+   return (n_late);
+}
+
+/*
+ * inner loop:
+ *  - sample = table[phase >> (32 - TBL_BITS)] * vol (+/-127 * 255)
+ *  - sum of all voices >> gain, saturated to +/-MAX/2, offset to
+ *    unsigned duty
+ */
+int Mixer::mix() {
+   Voice *v;
+   int32_t acc;
+   const int32_t half = PwmCore::MAX / 2;
+
+   acc = 0;
+   for (v = voice; v < voice + N_VOICES; v++) {
+      if (v->vol == 0)
+         continue;
+      acc = acc + (int32_t) v->tbl[v->phase >> (32 - TBL_BITS)] * v->vol;
+      v->phase = v->phase + v->step;
+      if (v->left != HOLD) {
+         v->left--;
+         if (v->left <= 0)
+            v->vol = 0;
+      }
+   }
+   acc = acc >> gain;
+   if (acc > half - 1)
+      acc = half - 1;
+   else if (acc < -half)
+      acc = -half;
+   return ((int) (acc + half));
+}
+
+/* output on the sample grid; a late call computes the missed samples */
+void Mixer::update() {
+   unsigned long now_q4;
+   int n, duty;
+
+   if (period_q4 == 0)
+      return;   // init() not called
+   now_q4 = now_us() * 16;
+   if ((long) (now_q4 - next_q4) < 0)
+      return;
+   duty = 0;
+   for (n = 0; n < MAX_CATCHUP && (long) (now_q4 - next_q4) >= 0; n++) {
+      duty = mix();
+      next_q4 = next_q4 + period_q4;
+   }
+   n_late = n_late + n - 1;
+   // too far behind: resynchronize instead of bursting
+   if ((long) (now_q4 - next_q4) >= 0) {
+      next_q4 = now_q4 + period_q4;
+      n_late++;
+   }
+   _pwm->set_duty(duty, ch);
+}
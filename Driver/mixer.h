@@ -0,0 +1,197 @@
+/*****************************************************************//**
+ * @file mixer.h
+ *
+ * @brief software wavetable mixer on a pwm channel (1-bit dac)
+ *
+ * Description:
+ *  - N_VOICES wavetable voices (sine, triangle, sawtooth, square)
+ *  - 32-bit phase accumulator per voice; the top TBL_BITS bits
+ *    index a 256-entry 8-bit table built at compile time
+ *  - voices are mixed in integer and saturated to the pwm range,
+ *    so overlapping effects clip instead of wrapping around
+ *  - update() is a periodic task called from the main loop; each
+ *    elapsed sample period advances the voices and the newest
+ *    sample is written into the pwm duty register
+ *  - the pwm carrier must run well above the sample rate; init()
+ *    sets it to the highest rate the 10-bit pwm core supports
+ *    (prescaler 0: f_sys/2^10, about 97.6 kHz)
+ *  - all channels of the pwm core share the carrier, so init() also
+ *    changes it for the other channels (e.g., the rgb leds);
+ *    their duty cycles are not affected
+ *
+ * CPU budget (100 MHz MCS, hardware multiplier):
+ *  - a 16 kHz sample period is 6250 clocks; mix() is allotted
+ *    10% of it (625 clocks) for 4 voices
+ *  - per active voice: table lookup, one multiply, accumulate,
+ *    phase step and duration count (about 15 instructions);
+ *    silent voices cost one compare
+ *  - update() must be called at least once per sample period;
+ *    missed periods are computed but only the newest one reaches
+ *    the dac (counted by late())
+ *
+ *********************************************************************/
+
+#ifndef _MIXER_H_INCLUDED
+#define _MIXER_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+
+/**
+ * software mixer
+ *  - output on one pwm channel (channel 6 is routed to pmod ja)
+ *
+ */
+class Mixer {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      N_VOICES = 4,       /**< # voices */
+      TBL_BITS = 8,       /**< # table index bits */
+      TBL_LEN = 1 << TBL_BITS, /**< # table entries */
+      DEF_RATE = 16000,   /**< default sample rate in Hz */
+      DEF_CH = 6,         /**< default pwm channel (pmod ja) */
+      DEF_GAIN = 7,       /**< default output shift (2 full voices = full scale) */
+      MAX_CATCHUP = 8,    /**< max # samples computed per update() */
+      HOLD = -1           /**< note duration: play until note_off() */
+   };
+   /**
+    * waveforms
+    *
+    */
+   enum {
+      WAVE_SINE = 0,
+      WAVE_TRI,
+      WAVE_SAW,
+      WAVE_SQUARE,
+      N_WAVES
+   };
+
+   /**
+    * constructor
+    *
+    * @param pwm pointer to pwm core instance
+    * @param channel pwm channel used as dac
+    *
+    */
+   Mixer(PwmCore *pwm, int channel);
+   ~Mixer();  // not used
+
+   /**
+    * set pwm carrier frequency and sample rate; silence all voices
+    *
+    * @param rate sample rate in Hz
+    *
+    */
+   void init(int rate = DEF_RATE);
+
+   /**
+    * set output gain
+    *
+    * @param shift mix sum is divided by 2^shift before saturation
+    *
+    */
+   void set_gain(int shift);
+
+   /**
+    * start a voice at a MIDI note
+    *
+    * @param voice voice number (0 to N_VOICES-1)
+    * @param note MIDI note number (0 to 127; 69 is A4)
+    * @param wave waveform (WAVE_SINE ...)
+    * @param vol volume (0 to 255)
+    * @param ms duration in ms (HOLD: until note_off())
+    *
+    */
+   void note_on(int voice, int note, int wave, int vol, int ms);
+
+   /**
+    * start a note on a free voice (or the one closest to its end)
+    *
+    * @param note MIDI note number
+    * @param wave waveform
+    * @param vol volume (0 to 255)
+    * @param ms duration in ms
+    * @return voice number used
+    *
+    */
+   int play(int note, int wave, int vol, int ms);
+
+   /**
+    * silence a voice
+    *
+    * @param voice voice number
+    *
+    */
+   void note_off(int voice);
+
+   /**
+    * change the frequency of a playing voice (slides/vibrato)
+    *
+    * @param voice voice number
+    * @param hz frequency in Hz (below sample rate/2)
+    *
+    */
+   void set_freq(int voice, int hz);
+
+   /**
+    * change the volume of a playing voice
+    *
+    * @param voice voice number
+    * @param vol volume (0 to 255)
+    *
+    */
+   void set_vol(int voice, int vol);
+
+   /**
+    * check whether a voice is sounding
+    *
+    * @param voice voice number
+    * @return 1: sounding; 0: silent
+    *
+    */
+   int active(int voice);
+
+   /**
+    * periodic task; output the samples due since the last call
+    *
+    */
+   void update();
+
+   /**
+    * compute one sample and advance all voices (no i/o)
+    *
+    * @return pwm duty (0 to PwmCore::MAX-1)
+    *
+    */
+   int mix();
+
+   /**
+    * # sample periods that were computed but not output
+    *
+    */
+   unsigned long late();
+
+private:
+   struct Voice {
+      const int8_t *tbl;
+      uint32_t phase;
+      uint32_t step;
+      int32_t vol;       // 0: silent
+      int32_t left;      // # samples to play; HOLD: no limit
+   };
+   PwmCore *_pwm;
+   int ch;
+   int gain;
+   Voice voice[N_VOICES];
+   uint32_t step_per_hz;           // 2^32/rate
+   uint32_t samples_per_ms;
+   unsigned long period_q4;        // sample period in 1/16 us
+   unsigned long next_q4;          // due time of next sample in 1/16 us
+   unsigned long n_late;
+};
+
+#endif  // _MIXER_H_INCLUDED
@@ -0,0 +1,72 @@
+/*****************************************************************//**
+ * @file osd_shadow.cpp
+ *
+ * @brief implementation of OsdShadow class
+ *
+ ********************************************************************/
+
+#include "osd_shadow.h"
+
+OsdShadow::OsdShadow(OsdCore *osd) {
+   _osd = osd;
+   clr_screen();
+   invalidate();
+}
+
+OsdShadow::~OsdShadow() {
+}  // not used
+
+void OsdShadow::wr_char(int x, int y, char ch, int reverse) {
+   uint8_t data;
+
+   if (x < 0 || x >= COLS || y < 0 || y >= ROWS)
+      return;
+   data = (uint8_t) ch & 0x7f;
+   if (reverse)
+      data = data | 0x80;
+   if (back[y][x] != data) {
+      back[y][x] = data;
+      dirty = dirty | (1UL << y);
+   }
+}
+
+int OsdShadow::wr_str(int x, int y, const char *s) {
+   for (; *s != 0; s++, x++)
+      wr_char(x, y, *s);
+   return (x);
+}
+
+void OsdShadow::clr_screen() {
+   int x, y;
+
+   for (y = 0; y < ROWS; y++)
+      for (x = 0; x < COLS; x++)
+         back[y][x] = OsdCore::NULL_CHAR;
+   dirty = (1UL << ROWS) - 1;
+}
+
+void OsdShadow::invalidate() {
+   all = 1;
+   dirty = (1UL << ROWS) - 1;
+}
+
+int OsdShadow::flush() {
+   int x, y, n;
+   uint8_t data;
+
+   n = 0;
+   for (y = 0; dirty != 0; y++, dirty >>= 1) {
+      if ((dirty & 0x01) == 0)
+         continue;
+      for (x = 0; x < COLS; x++) {
+         data = back[y][x];
+         if (all || front[y][x] != data) {
+            front[y][x] = data;
+            _osd->wr_char(x, y, (char) (data & 0x7f), data >> 7);
+            n++;
+         }
+      }
+   }
+   all = 0;
+   return (n);
+}
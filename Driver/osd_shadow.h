@@ -0,0 +1,98 @@
+/*****************************************************************//**
+ * @file osd_shadow.h
+ *
+ * @brief shadowed osd text layer: draw in RAM, write only changes
+ *
+ * Description:
+ *  - the application draws into a back buffer (same calls as
+ *    OsdCore); flush() compares it with a copy of what the tile RAM
+ *    holds and writes only the tiles that differ
+ *  - a dirty bit per row limits the compare to rows drawn since the
+ *    last flush
+ *  - redrawing a whole screen every frame thus costs one MMIO write
+ *    per changed tile instead of 2400
+ *  - colors and bypass still go to the OsdCore directly
+ *
+ *********************************************************************/
+
+#ifndef _OSD_SHADOW_H_INCLUDED
+#define _OSD_SHADOW_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * osd shadow buffer
+ *
+ */
+class OsdShadow {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      COLS = OsdCore::CHAR_X_MAX,
+      ROWS = OsdCore::CHAR_Y_MAX
+   };
+
+   /**
+    * constructor
+    *
+    * @param osd pointer to osd core instance
+    * @note the first flush() writes every tile
+    *
+    */
+   OsdShadow(OsdCore *osd);
+   ~OsdShadow();  // not used
+
+   /**
+    * draw a char into the back buffer
+    *
+    * @param x column (0 to COLS-1; others ignored)
+    * @param y row (0 to ROWS-1; others ignored)
+    * @param ch char
+    * @param reverse 0: normal display; 1: reversed display
+    *
+    */
+   void wr_char(int x, int y, char ch, int reverse = 0);
+
+   /**
+    * draw a string into the back buffer
+    *
+    * @param x column of the first char
+    * @param y row
+    * @param s null-terminated string
+    * @return column after the last char
+    *
+    */
+   int wr_str(int x, int y, const char *s);
+
+   /**
+    * clear the back buffer (transparent tiles)
+    *
+    */
+   void clr_screen();
+
+   /**
+    * forget what the tile RAM holds (next flush() writes every tile)
+    *
+    */
+   void invalidate();
+
+   /**
+    * write the changed tiles to the osd core
+    *
+    * @return # tiles written
+    *
+    */
+   int flush();
+
+private:
+   OsdCore *_osd;
+   uint8_t back[ROWS][COLS];    // drawn by the application
+   uint8_t front[ROWS][COLS];   // held by the tile RAM
+   uint32_t dirty;              // one bit per row
+   int all;                     // front[] unknown
+};
+
+#endif  // _OSD_SHADOW_H_INCLUDED
@@ -0,0 +1,158 @@
+/*****************************************************************//**
+ * @file pcm_capture.cpp
+ *
+ * @brief implementation of PcmCapture class
+ *
+ ********************************************************************/
+
+#include "pcm_capture.h"
+
+PcmCapture::PcmCapture(DdfsCore *ddfs, UartCore *port) {
+   _ddfs = ddfs;
+   _port = port;
+   running = 0;
+   rate = DEF_RATE;
+   period_us = 1000000 / DEF_RATE;
+   fill_blk = 0;
+   fill_cnt = 0;
+   full = 0;
+   tx_seg = 3;
+   seq = 0;
+   drop_blk[0] = drop_blk[1] = 0;
+   drop_next = 0;
+   drop_total = 0;
+}
+
+PcmCapture::~PcmCapture() {
+}  // not used
+
+void PcmCapture::start(int r) {
+   rate = (r > 0) ? r : DEF_RATE;
+   period_us = 1000000 / rate;
+   fill_blk = 0;
+   fill_cnt = 0;
+   full = 0;
+   drop_blk[0] = drop_blk[1] = 0;
+   drop_next = 0;
+   drop_total = 0;
+   next_us = now_us();
+   running = 1;
+}
+
+void PcmCapture::stop() {
+   running = 0;
+}
+
+int PcmCapture::active() {
+   return (running);
+}
+
+uint32_t PcmCapture::dropped() {
+   return (drop_total);
+}
+
+void PcmCapture::update() {
+   unsigned long now;
+   long late;
+
+   if (running) {
+      now = now_us();
+      late = (long) (now - next_us);
+      if (late >= 0) {
+         if (late >= (long) period_us) {
+            // fell behind; record the gap with the block it falls in
+            if (fill_cnt == BLK_LEN)
+               drop_next = drop_next + late / period_us;
+            else
+               drop_blk[fill_blk] = drop_blk[fill_blk] + late / period_us;
+            drop_total = drop_total + late / period_us;
+            next_us = now;
+         }
+         next_us = next_us + period_us;
+         sample();
+      }
+   }
+   send();
+}
+
+// store one sample; swap blocks when the fill block is full
+void PcmCapture::sample() {
+   if (fill_cnt == BLK_LEN) {
+      // both blocks busy (uart too slow); lose the sample, which
+      // comes after the full block, i.e., before the next one
+      drop_next++;
+      drop_total++;
+      return;
+   }
+   blk[fill_blk][fill_cnt] = _ddfs->read_pcm();
+   fill_cnt++;
+   if (fill_cnt == BLK_LEN && !full)
+      swap_blocks();
+}
+
+// queue the full fill block; the other one starts with the pending gap
+void PcmCapture::swap_blocks() {
+   full = 1;
+   fill_blk = 1 - fill_blk;
+   fill_cnt = 0;
+   drop_blk[fill_blk] = drop_next;
+   drop_next = 0;
+}
+
+void PcmCapture::frame_start() {
+   const uint8_t *p;
+   int i;
+
+   hdr[0] = SYNC0;
+   hdr[1] = SYNC1;
+   hdr[2] = seq;
+   hdr[3] = BLK_LEN;
+   hdr[4] = (uint8_t) rate;
+   hdr[5] = (uint8_t) (rate >> 8);
+   hdr[6] = (uint8_t) drop_blk[1 - fill_blk];
+   hdr[7] = (uint8_t) (drop_blk[1 - fill_blk] >> 8);
+   seq++;
+   // checksum over header (after sync) and payload
+   chk = 0;
+   for (i = 2; i < HDR_LEN; i++)
+      chk = chk + hdr[i];
+   p = (const uint8_t *) blk[1 - fill_blk];
+   for (i = 0; i < 2 * BLK_LEN; i++)
+      chk = chk + p[i];
+   chk = (uint8_t) -chk;
+   tx_ptr = hdr;
+   tx_cnt = HDR_LEN;
+   tx_seg = 0;
+}
+
+/* push bytes until the uart fifo is full; never busy-waits */
+void PcmCapture::send() {
+   if (tx_seg == 3) {
+      if (!full)
+         return;
+      frame_start();
+   }
+   while (!_port->tx_fifo_full()) {
+      if (tx_cnt == 0) {
+         tx_seg++;
+         if (tx_seg == 1) {
+            // payload: pcm samples stored little endian on MicroBlaze
+            tx_ptr = (const uint8_t *) blk[1 - fill_blk];
+            tx_cnt = 2 * BLK_LEN;
+         } else if (tx_seg == 2) {
+            tx_ptr = &chk;
+            tx_cnt = 1;
+         } else {
+            // frame done; release the block
+            tx_seg = 3;
+            full = 0;
+            if (fill_cnt == BLK_LEN)
+               swap_blocks();   // fill block completed while sending
+            return;
+         }
+      }
+      _port->tx_byte(*tx_ptr);
+      tx_ptr++;
+      tx_cnt--;
+   }
+}
@@ -0,0 +1,121 @@
+/*****************************************************************//**
+ * @file pcm_capture.h
+ *
+ * @brief capture ddfs pcm samples and stream them via uart
+ *
+ * Description:
+ *  - sample DdfsCore::read_pcm() at a fixed rate into one of two
+ *    RAM blocks (double buffering)
+ *  - a full block is sent as one frame while the other block fills
+ *  - update() is a periodic task; it never waits on the uart
+ *  - frame format (multi-byte fields little endian):
+ *      0xa5 0x5a | seq | n | rate (2) | dropped (2) | n x pcm (2) | chk
+ *    - seq: frame counter (mod 256)
+ *    - n: # samples in frame
+ *    - rate: sample rate in Hz
+ *    - dropped: # samples lost between the previous block and the
+ *      end of this one; a receiver inserts them before this block
+ *      (a late sample inside a block is placed at its start)
+ *    - chk: 2's complement of the byte sum from seq to last pcm byte
+ *  - uart rate must exceed 2*rate*10 baud (e.g., 230400 for 8 kHz)
+ *
+ *********************************************************************/
+
+#ifndef _PCM_CAPTURE_H_INCLUDED
+#define _PCM_CAPTURE_H_INCLUDED
+
+#include "chu_init.h"
+#include "ddfs_core.h"
+
+/**
+ * pcm capture driver
+ *
+ */
+class PcmCapture {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      SYNC0 = 0xa5,        /**< first sync byte */
+      SYNC1 = 0x5a,        /**< second sync byte */
+      HDR_LEN = 8,         /**< # header bytes (including sync) */
+      BLK_LEN = 128,       /**< # samples per block/frame */
+      DEF_RATE = 8000      /**< default sample rate in Hz */
+   };
+
+   /**
+    * constructor
+    *
+    * @param ddfs pointer to ddfs core instance
+    * @param port pointer to uart core instance used for streaming
+    *
+    */
+   PcmCapture(DdfsCore *ddfs, UartCore *port);
+   ~PcmCapture();  // not used
+
+   /**
+    * start capture
+    *
+    * @param rate sample rate in Hz
+    *
+    */
+   void start(int rate);
+
+   /**
+    * stop capture (a frame being sent is completed by update())
+    *
+    */
+   void stop();
+
+   /**
+    * check whether capture is running
+    *
+    * @return 1: running; 0: stopped
+    *
+    */
+   int active();
+
+   /**
+    * periodic task; take a sample when due and feed the uart
+    *
+    */
+   void update();
+
+   /**
+    * number of samples lost (late sampling or both blocks busy)
+    *
+    */
+   uint32_t dropped();
+
+private:
+   DdfsCore *_ddfs;
+   UartCore *_port;
+   int running;
+   int rate;
+   unsigned long period_us;
+   unsigned long next_us;
+   /* double buffer */
+   int16_t blk[2][BLK_LEN];
+   int fill_blk;           // block being filled
+   int fill_cnt;           // # samples in fill block
+   int full;               // other block waits to be sent
+   /* frame being sent */
+   uint8_t hdr[HDR_LEN];
+   const uint8_t *tx_ptr;
+   int tx_cnt;             // # bytes left in current segment
+   int tx_seg;             // 0: header; 1: payload; 2: checksum; 3: idle
+   uint8_t chk;
+   uint8_t seq;
+   uint16_t drop_blk[2];   // samples lost before/while a block filled
+   uint16_t drop_next;     // samples lost after the fill block filled up
+   uint32_t drop_total;
+   /* methods */
+   void sample();
+   void swap_blocks();
+   void frame_start();
+   void send();
+};
+
+#endif  // _PCM_CAPTURE_H_INCLUDED
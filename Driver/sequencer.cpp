@@ -0,0 +1,135 @@
+/*****************************************************************//**
+ * @file sequencer.cpp
+ *
+ * @brief implementation of Sequencer class
+ *
+ ********************************************************************/
+
+#include "sequencer.h"
+
+// order list used for a single pattern
+static const uint8_t SINGLE_ORDER[] = { 0 };
+
+Sequencer::Sequencer(AdsrCore *adsr) {
+   _adsr = adsr;
+   cur_env = -1;
+   music.active = 0;
+   sfx.active = 0;
+   set_tempo(DEF_BPM, DEF_STEPS);
+}
+
+Sequencer::~Sequencer() {
+}  // not used
+
+// step length computed once per tempo change
+void Sequencer::set_tempo(int bpm, int steps) {
+   if (bpm <= 0)
+      bpm = DEF_BPM;
+   if (steps <= 0)
+      steps = DEF_STEPS;
+   step_us = 60000000UL / (unsigned long) (bpm * steps);
+   step_ms = (int) (step_us / 1000);
+}
+
+void Sequencer::play(const SeqNote *const *patterns, const uint8_t *order,
+      int n_order, int loop) {
+   if (n_order <= 0) {
+      music.active = 0;   // empty order list: nothing to play
+      return;
+   }
+   music.pat = patterns;
+   music.order = order;
+   music.n_order = n_order;
+   music.ord = 0;
+   music.cur = patterns[order[0]];
+   music.loop = loop;
+   music.next_us = now_us();
+   music.active = 1;
+}
+
+void Sequencer::play_sfx(const SeqNote *pattern) {
+   sfx.single = pattern;
+   sfx.pat = &sfx.single;
+   sfx.order = SINGLE_ORDER;
+   sfx.n_order = 1;
+   sfx.ord = 0;
+   sfx.cur = pattern;
+   sfx.loop = 0;
+   sfx.next_us = now_us();
+   sfx.active = 1;
+}
+
+void Sequencer::stop() {
+   music.active = 0;
+   sfx.active = 0;
+   _adsr->abort();
+}
+
+int Sequencer::playing() {
+   return (music.active || sfx.active);
+}
+
+/*
+ * both tracks keep time; the sound effect has priority on the voice
+ *  - music notes due during an effect are skipped (not delayed)
+ *  - when the effect ends, music is heard again at its next note
+ */
+void Sequencer::update() {
+   const SeqNote *m, *s;
+   unsigned long now;
+
+   if (!music.active && !sfx.active)
+      return;
+   now = now_us();
+   m = 0;
+   s = 0;
+   if (music.active && (long) (now - music.next_us) >= 0)
+      m = step(&music);
+   if (sfx.active && (long) (now - sfx.next_us) >= 0) {
+      s = step(&sfx);
+      if (!s && !m)
+         _adsr->abort();   // effect ended between music notes
+   }
+   if (s)
+      sound(s);
+   else if (m && !sfx.active)
+      sound(m);
+}
+
+// return note starting now and advance cursor; 0 if track ended
+const SeqNote *Sequencer::step(SeqTrack *t) {
+   const SeqNote *n;
+
+   n = t->cur;
+   if (n->pitch == END) {
+      t->ord++;
+      if (t->ord >= t->n_order) {
+         if (!t->loop) {
+            t->active = 0;
+            return (0);
+         }
+         t->ord = 0;
+      }
+      n = t->pat[t->order[t->ord]];
+      if (n->pitch == END) {   // empty pattern
+         t->active = 0;
+         return (0);
+      }
+   }
+   t->cur = n + 1;
+   t->next_us = t->next_us + n->dur * step_us;
+   return (n);
+}
+
+// program ddfs/adsr for one note
+void Sequencer::sound(const SeqNote *n) {
+   if (n->pitch == REST) {
+      _adsr->abort();
+      return;
+   }
+   if (n->env != cur_env) {
+      _adsr->select_env(n->env);
+      cur_env = n->env;
+   }
+   _adsr->play_note(n->pitch, n->oct, n->dur * step_ms);
+}
@@ -0,0 +1,136 @@
+/*****************************************************************//**
+ * @file sequencer.h
+ *
+ * @brief non-blocking music and sound-effect sequencer
+ *
+ * Description:
+ *  - tracker-style note events (pitch, octave, duration, envelope)
+ *  - a song is an order list of patterns played at a fixed tempo
+ *  - one music track and one sound-effect track share the single
+ *    ddfs/adsr voice; an effect preempts the music, which keeps its
+ *    timing and resumes at its next note boundary
+ *  - update() is called from the main loop; ddfs/adsr registers are
+ *    written only at note boundaries
+ *
+ *********************************************************************/
+
+#ifndef _SEQUENCER_H_INCLUDED
+#define _SEQUENCER_H_INCLUDED
+
+#include "chu_init.h"
+#include "adsr_core.h"
+
+/**
+ * note event
+ *  - pitch: 0 to 11 for C, C#, D, ..., B; or Sequencer::REST/END
+ *  - dur: # steps (1/steps_per_beat of a beat)
+ *  - env: predefined envelope (AdsrCore::select_env())
+ */
+struct SeqNote {
+   uint8_t pitch;
+   uint8_t oct;
+   uint8_t dur;
+   uint8_t env;
+};
+
+/**
+ * sequencer
+ *  - patterns are END-terminated SeqNote arrays (may live in ROM)
+ *
+ */
+class Sequencer {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      REST = 12,           /**< silent step */
+      END = 0xff,          /**< end of pattern */
+      DEF_BPM = 150,       /**< default tempo */
+      DEF_STEPS = 4        /**< default # steps per beat */
+   };
+
+   /**
+    * constructor
+    *
+    * @param adsr pointer to adsr core instance (connected to a ddfs core)
+    *
+    */
+   Sequencer(AdsrCore *adsr);
+   ~Sequencer();  // not used
+
+   /**
+    * set tempo
+    *
+    * @param bpm beats per minute
+    * @param steps # steps per beat
+    *
+    */
+   void set_tempo(int bpm, int steps);
+
+   /**
+    * start a song (music track)
+    *
+    * @param patterns array of pattern pointers
+    * @param order order list (indexes into patterns)
+    * @param n_order # entries in order list
+    * @param loop 1: repeat the song; 0: play once
+    * @note n_order 0 or less stops the music track
+    *
+    */
+   void play(const SeqNote *const *patterns, const uint8_t *order,
+         int n_order, int loop);
+
+   /**
+    * start a sound effect (preempts the music)
+    *
+    * @param pattern END-terminated note array
+    *
+    */
+   void play_sfx(const SeqNote *pattern);
+
+   /**
+    * stop music and sound effect
+    *
+    */
+   void stop();
+
+   /**
+    * check whether music or a sound effect is playing
+    *
+    * @return 1: playing; 0: idle
+    *
+    */
+   int playing();
+
+   /**
+    * main-loop tick; start the next note when a boundary is due
+    *
+    */
+   void update();
+
+private:
+   /* track cursor */
+   struct SeqTrack {
+      const SeqNote *const *pat;
+      const uint8_t *order;
+      int n_order;
+      int ord;
+      const SeqNote *cur;
+      const SeqNote *single;
+      unsigned long next_us;
+      int loop;
+      int active;
+   };
+   AdsrCore *_adsr;
+   unsigned long step_us;
+   int step_ms;
+   int cur_env;
+   SeqTrack music, sfx;
+   /* methods */
+   const SeqNote *step(SeqTrack *t);
+   void sound(const SeqNote *n);
+};
+
+#endif  // _SEQUENCER_H_INCLUDED
@@ -70,14 +70,49 @@ void SpiCore::deassert_ss(int n)  //
 
 /* shift out write data and shift in read data */
 uint8_t SpiCore::transfer(uint8_t wr_data) {
-   uint32_t rd_data;
-
-   while (!ready()) {
-   };
-   io_write(base_addr, WRITE_DATA_REG, (uint32_t ) wr_data);
-   while (!ready()) {
-   };
-   rd_data = io_read(base_addr, RD_DATA_REG) & RX_DATA_FIELD;
-   return ((uint8_t) rd_data);
+   uint8_t rd_data;
+
+   burst(&wr_data, &rd_data, 1);
+   return (rd_data);
+}
+
+void SpiCore::transfer(const uint8_t *tx, uint8_t *rx, int len, int ss) {
+   assert_ss(ss);
+   burst(tx, rx, len);
+   deassert_ss(ss);
 }
 
+void SpiCore::write_then_read(const uint8_t *tx, int tx_len, uint8_t *rx,
+      int rx_len, int ss) {
+   assert_ss(ss);
+   burst(tx, 0, tx_len);
+   burst(0, rx, rx_len);
+   deassert_ss(ss);
+}
+
+/*
+ * keep the shifter busy:
+ *  - at most FIFO_DEPTH bytes in flight (tx fifo + shifter + rx fifo),
+ *    so neither fifo can overflow and tx_full never has to be checked
+ *  - a single status read per pass returns both rx_empty and rx data
+ */
+void SpiCore::burst(const uint8_t *tx, uint8_t *rx, int len) {
+   uint32_t rd_word;
+   int n_tx, n_rx;
+
+   n_tx = 0;
+   n_rx = 0;
+   while (n_rx < len) {
+      if (n_tx < len && (n_tx - n_rx) < FIFO_DEPTH) {
+         io_write(base_addr, WRITE_DATA_REG, (uint32_t) (tx ? tx[n_tx] : 0));
+         n_tx++;
+      }
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      if (!(rd_word & RX_EMPT_FIELD)) {
+         if (rx)
+            rx[n_rx] = (uint8_t) (rd_word & RX_DATA_FIELD);
+         io_write(base_addr, RM_RD_DATA_REG, 0); //dummy write to remove data from rx FIFO
+         n_rx++;
+      }
+   }
+}
@@ -19,6 +19,11 @@
  *  - multiple slave SPI devices can be connected to the master
  *  - the main program must coordinate the access
  *    (can use a "in_use" variable for access control)
+ *  - block transfers keep up to FIFO_DEPTH bytes in flight so the
+ *    shifter runs back-to-back
+ *
+ * MMIO subsystem HDL parameter:
+ *  - F: # address bits of tx/rx FIFO (FIFO_DEPTH = 2^F)
  *
  */
 class SpiCore {
@@ -36,16 +41,26 @@ public:
    enum {
       RD_DATA_REG = 0,    /**< 8-bit read data register */
       SS_REG = 1,         /**< 1-bit status register */
-      WRITE_DATA_REG = 2, /**< 8-bit write data register */
-      CTRL_REG = 3        /**< control register (ss/cpha/cpol/dvsr) */
+      WRITE_DATA_REG = 2, /**< 8-bit write data register (tx fifo) */
+      CTRL_REG = 3,       /**< control register (ss/cpha/cpol/dvsr) */
+      RM_RD_DATA_REG = 4  /**< remove read data offset (rx fifo) */
    };
    /**
     * Field masks
     *
     */
    enum {
-      READY_FIELD = 0x00000100, /**< bit 8 of rd_data_reg; ready bit */
-      RX_DATA_FIELD = 0x000000ff /**< bits 7..0 rd_data_reg; read data */
+      READY_FIELD = 0x00000100,   /**< bit 8 of rd_data_reg; ready bit */
+      RX_EMPT_FIELD = 0x00000200, /**< bit 9 of rd_data_reg; rx empty bit */
+      TX_FULL_FIELD = 0x00000400, /**< bit 10 of rd_data_reg; tx full bit */
+      RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
+   };
+   /**
+    * symbolic constant
+    *
+    */
+   enum {
+      FIFO_DEPTH = 4  /**< # entries of tx/rx fifo (2^F in HDL) */
    };
    /**
     * Constructor.
@@ -127,6 +142,36 @@ public:
     */
    uint8_t transfer(uint8_t wr_data);
 
+   /**
+    * shift out a block of write data and shift in a block of read data
+    *
+    *@param tx pointer to write data (NULL to send 0x00 dummy bytes)
+    *@param rx pointer to read data buffer (NULL to discard read data)
+    *@param len # bytes to be transferred
+    *@param ss slave device # (asserted for the whole transfer)
+    *
+    *@note bytes are queued in the tx fifo while earlier ones are still
+    *      shifting; one status read per pass serves both fifos
+    *
+    */
+   void transfer(const uint8_t *tx, uint8_t *rx, int len, int ss);
+
+   /**
+    * write a command/address sequence and then read a block of data
+    * in one slave-select cycle
+    *
+    *@param tx pointer to write data (e.g., command and register address)
+    *@param tx_len # bytes to be written
+    *@param rx pointer to read data buffer
+    *@param rx_len # bytes to be read
+    *@param ss slave device # (asserted for the whole transaction)
+    *
+    *@note read data shifted in during the write phase are discarded
+    *
+    */
+   void write_then_read(const uint8_t *tx, int tx_len, uint8_t *rx,
+         int rx_len, int ss);
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
@@ -134,6 +179,8 @@ private:
    uint16_t dvsr;
    int cpol;
    int cpha;
+   /* methods */
+   void burst(const uint8_t *tx, uint8_t *rx, int len);
 }
 ;
 
@@ -14,6 +14,13 @@ SsegCore::SsegCore(uint32_t core_base_addr) {
    // i.e., HI_PTN[0] is the leftmost led
    const uint8_t HI_PTN[]={0xff,0xf9,0x89,0xff,0xff,0xff,0xff,0xff};
    base_addr = core_base_addr;
+   dp = 0xff;
+   shadow_ok = 0;
+   scr_text = 0;
+   scr_len = 0;
+   scr_pos = 0;
+   scr_step_ms = DEF_SCROLL_MS;
+   scr_last_ms = 0;
    write_8ptn((uint8_t*) HI_PTN);
    set_dp(0x02);
 }
@@ -22,36 +29,36 @@ SsegCore::~SsegCore() {
 }
 // not used
 
-void SsegCore::write_led() {
-   int i, p;
-   uint32_t word = 0;
+// pack 4 patterns of one register; skip the bus write if unchanged
+void SsegCore::write_half(int h) {
+   int i, p, b;
+   uint32_t word;
 
-   // pack left 4 patterns into a 32-bit word
-   // ptn_buf[0] is the leftmost led
-   for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[3 - i];
-   }
+   // ptn_buf[0] is the rightmost led
+   b = 4 * h;
+   word = ((uint32_t) ptn_buf[b + 3] << 24) | ((uint32_t) ptn_buf[b + 2] << 16)
+         | ((uint32_t) ptn_buf[b + 1] << 8) | ptn_buf[b];
    // incorporate decimal points (bit 7 of pattern)
    for (i = 0; i < 4; i++) {
-      p = bit_read(dp, i);
-      bit_write(word, 7 + 8 * i, p);
-   }
-   io_write(base_addr, DATA_LOW_REG, word);
-   // pack right 4 patterns into a 32-bit word
-   for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[7 - i];
-   }
-   // incorporate decimal points
-   for (i = 0; i < 4; i++) {
-      p = bit_read(dp, 4 + i);
+      p = bit_read(dp, b + i);
       bit_write(word, 7 + 8 * i, p);
    }
-   io_write(base_addr, DATA_HIGH_REG, word);
+   if (shadow_ok && word == shadow[h])
+      return;
+   shadow[h] = word;
+   io_write(base_addr, (h == 0) ? DATA_LOW_REG : DATA_HIGH_REG, word);
+}
+
+void SsegCore::write_led() {
+   write_half(0);
+   write_half(1);
+   shadow_ok = 1;
 }
 
 void SsegCore::write_8ptn(uint8_t *ptn_array) {
    int i;
 
+   scr_text = 0;
    for (i = 0; i < 8; i++) {
       ptn_buf[i] = *ptn_array;
       ptn_array++;
@@ -60,8 +67,9 @@ void SsegCore::write_8ptn(uint8_t *ptn_array) {
 }
 
 void SsegCore::write_1ptn(uint8_t pattern, int pos) {
+   scr_text = 0;
    ptn_buf[pos] = pattern;
-   write_led();
+   write_half(pos >> 2);
 }
 
 // set decimal points,
@@ -85,3 +93,152 @@ uint8_t SsegCore::h2s(int hex) {
       ptn = 0xff;
    return (ptn);
 }
+
+// ascii 0x20 to 0x5f; active-high segments (gfedcba)
+uint8_t SsegCore::a2s(char ch) {
+   static const uint8_t FONT[64] = {
+      0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x02,   // space ! " # $ % & '
+      0x39, 0x0f, 0x00, 0x00, 0x00, 0x40, 0x00, 0x52,   // ( ) * + , - . /
+      0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07,   // 0-7
+      0x7f, 0x6f, 0x00, 0x00, 0x00, 0x48, 0x00, 0x53,   // 8 9 : ; < = > ?
+      0x00, 0x77, 0x7c, 0x39, 0x5e, 0x79, 0x71, 0x3d,   // @ A-G
+      0x76, 0x06, 0x1e, 0x75, 0x38, 0x15, 0x54, 0x3f,   // H-O
+      0x73, 0x67, 0x50, 0x6d, 0x78, 0x3e, 0x1c, 0x2a,   // P-W
+      0x76, 0x6e, 0x5b, 0x39, 0x64, 0x0f, 0x23, 0x08 }; // X-Z [ \ ] ^ _
+   int c = (uint8_t) ch;
+
+   if (c >= 'a' && c <= 'z')
+      c = c - 'a' + 'A';
+   if (c < 0x20 || c > 0x5f)
+      return (BLANK_PTN);
+   return ((uint8_t) ~FONT[c - 0x20]);   // active low; MSB 1
+}
+
+/*
+ * double dabble: before each shift, add 3 to every bcd digit >= 5;
+ * digit+3 >= 8 exactly when digit >= 5, so bit 3 of (bcd + 0x33333333)
+ * flags the digits to adjust, all 8 in parallel
+ */
+uint32_t SsegCore::bin2bcd(uint32_t bin) {
+   uint32_t bcd, c;
+   int i;
+
+   bcd = 0;
+   for (i = 26; i >= 0; i--) {   // 99,999,999 < 2^27
+      c = (bcd + 0x33333333) & 0x88888888;
+      bcd = bcd + ((c >> 2) | (c >> 3));
+      bcd = (bcd << 1) | ((bin >> i) & 0x01);
+   }
+   return (bcd);
+}
+
+// write digits (bcd or hex nibbles) into ptn_buf[pos..pos+width-1]
+void SsegCore::fill_field(uint32_t digits, int pos, int width, int neg, int hex) {
+   int i;
+   uint8_t ptn;
+
+   scr_text = 0;
+   for (i = 0; i < width; i++) {
+      if (i == 0 || hex || digits != 0) {
+         ptn = h2s(digits & 0x0f);
+      } else if (neg) {
+         ptn = MINUS_PTN;
+         neg = 0;
+      } else {
+         ptn = BLANK_PTN;
+      }
+      ptn_buf[pos + i] = ptn;
+      digits = digits >> 4;
+   }
+   write_led();
+}
+
+void SsegCore::show_dec(int n) {
+   show_dec(n, 0, N_DIGITS);
+}
+
+void SsegCore::show_dec(int n, int pos, int width) {
+   static const uint32_t POW10[N_DIGITS + 1] = { 1, 10, 100, 1000, 10000,
+         100000, 1000000, 10000000, 100000000 };
+   uint32_t mag;
+   int neg, i;
+
+   if (pos < 0 || pos >= N_DIGITS || width < 1)
+      return;
+   if (width > N_DIGITS - pos)
+      width = N_DIGITS - pos;
+   neg = (n < 0);
+   mag = neg ? (0u - (uint32_t) n) : (uint32_t) n;
+   // magnitude must fit in the field (one digit less for the sign)
+   if (mag >= POW10[width - neg]) {
+      scr_text = 0;
+      for (i = 0; i < width; i++)
+         ptn_buf[pos + i] = MINUS_PTN;
+      write_led();
+      return;
+   }
+   fill_field(bin2bcd(mag), pos, width, neg, 0);
+}
+
+void SsegCore::show_hex(uint32_t x) {
+   show_hex(x, 0, N_DIGITS);
+}
+
+void SsegCore::show_hex(uint32_t x, int pos, int width) {
+   if (pos < 0 || pos >= N_DIGITS || width < 1)
+      return;
+   if (width > N_DIGITS - pos)
+      width = N_DIGITS - pos;
+   fill_field(x, pos, width, 0, 1);
+}
+
+void SsegCore::scroll(const char *text, int step_ms) {
+   int n;
+
+   for (n = 0; text[n] != 0; n++)
+      ;
+   scr_len = n;
+   scr_step_ms = (step_ms > 0) ? step_ms : DEF_SCROLL_MS;
+   scr_pos = 1;
+   scr_last_ms = now_ms();
+   scr_text = text;
+   scroll_frame();
+}
+
+void SsegCore::stop_scroll() {
+   scr_text = 0;
+}
+
+int SsegCore::scrolling() {
+   return (scr_text != 0);
+}
+
+void SsegCore::update() {
+   unsigned long now;
+
+   if (scr_text == 0)
+      return;
+   now = now_ms();
+   if ((now - scr_last_ms) < scr_step_ms)
+      return;
+   if ((now - scr_last_ms) < 2 * scr_step_ms)
+      scr_last_ms = scr_last_ms + scr_step_ms;
+   else
+      scr_last_ms = now;
+   // text enters at the right; one blank frame between repeats
+   scr_pos++;
+   if (scr_pos > scr_len + N_DIGITS)
+      scr_pos = 1;
+   scroll_frame();
+}
+
+// window of 8 characters ending at text[scr_pos-1] (rightmost digit)
+void SsegCore::scroll_frame() {
+   int p, idx;
+
+   for (p = 0; p < N_DIGITS; p++) {
+      idx = scr_pos - 1 - p;
+      ptn_buf[p] = (idx >= 0 && idx < scr_len) ? a2s(scr_text[idx]) : (uint8_t) BLANK_PTN;
+   }
+   write_led();
+}
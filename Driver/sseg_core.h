@@ -18,6 +18,10 @@
  *  - an 8-element buffer (ptn_buf[]) stores the 8 7-seg patterns.
  *  - dp stores the decimal point pattern
  *  - the 7-seg pattern and dp combined in write_led()
+ *  - the packed register words are shadowed; a register is written
+ *    only when its word changes
+ *  - numbers are converted with shift-add-3 (no division)
+ *  - scrolling text runs from update() (non-blocking)
  *  - will work for 4-digit 7-seg display (ignoring upper 4 digits)
  *  - if modified for an 8-by-8 LED matrix, dp portion should be removed
  */
@@ -30,6 +34,16 @@ public:
       DATA_LOW_REG = 0, /**< 32-bit data for right 4 digits */
       DATA_HIGH_REG = 1 /**< 32-bit data for left 4 digits */
    };
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      N_DIGITS = 8,        /**< # digits */
+      BLANK_PTN = 0xff,    /**< all segments off */
+      MINUS_PTN = 0xbf,    /**< segment g only */
+      DEF_SCROLL_MS = 250  /**< default scroll step in ms */
+   };
 
    /**
     * constructor
@@ -70,14 +84,94 @@ public:
     */
    void set_dp(uint8_t pt);
 
+   /**
+    * convert an ascii character to 7-seg pattern
+    * @param ch character (digits, letters, space, '-', '_', '=')
+    * @return 7-seg pattern w/ MSB equal to 1
+    * @note letters are approximated; lower case shown as upper case;
+    *       unsupported characters are blank
+    */
+   uint8_t a2s(char ch);
+
+   /**
+    * convert binary to packed bcd (shift-add-3; no division)
+    * @param bin binary number (0 to 99,999,999)
+    * @return 8 bcd digits, least significant digit in bits 3-0
+    */
+   static uint32_t bin2bcd(uint32_t bin);
+
+   /**
+    * show a signed decimal number on all 8 digits
+    * @param n number (-9,999,999 to 99,999,999)
+    * @note leading zeros blanked; dashes if out of range
+    */
+   void show_dec(int n);
+
+   /**
+    * show a signed decimal number in a field (e.g., a scoreboard)
+    * @param n number
+    * @param pos position of the field's rightmost digit
+    * @param width # digits of the field
+    * @note digits outside the field are unchanged
+    * @note leading zeros blanked; dashes if n does not fit
+    */
+   void show_dec(int n, int pos, int width);
+
+   /**
+    * show an unsigned hexadecimal number on all 8 digits
+    * @param x number
+    */
+   void show_hex(uint32_t x);
+
+   /**
+    * show the low hexadecimal digits of a number in a field
+    * @param x number
+    * @param pos position of the field's rightmost digit
+    * @param width # digits of the field (leading zeros shown)
+    */
+   void show_hex(uint32_t x, int pos, int width);
+
+   /**
+    * scroll a text string from right to left (repeats until stopped)
+    * @param text null-terminated string (must stay valid while scrolling)
+    * @param step_ms time per one-digit shift
+    * @note write_1ptn()/write_8ptn()/show_xxx() stop scrolling
+    */
+   void scroll(const char *text, int step_ms = DEF_SCROLL_MS);
+
+   /**
+    * stop scrolling (display keeps its current patterns)
+    */
+   void stop_scroll();
+
+   /**
+    * check whether text is scrolling
+    * @return 1: scrolling; 0: otherwise
+    */
+   int scrolling();
+
+   /**
+    * periodic task; advance scrolling text when its step elapses
+    */
+   void update();
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
    uint8_t ptn_buf[8];    // led pattern buffer
    uint8_t dp;            // decimal point
+   uint32_t shadow[2];    // last words written to DATA_LOW/HIGH_REG
+   int shadow_ok;         // shadow matches registers
+   /* scrolling text */
+   const char *scr_text;
+   int scr_len, scr_pos;
+   unsigned long scr_step_ms, scr_last_ms;
    /* methods */
    void write_led();      // write patterns to reg
+   void write_half(int h);  // pack and write 4 digits (0: right; 1: left)
+   void fill_field(uint32_t digits, int pos, int width, int neg, int hex);
+   void scroll_frame();   // render the scroll window
 }
 ;
 
-#endif  // _SSEG_CORE_H_INCLUDED
\ No newline at end of file
+#endif  // _SSEG_CORE_H_INCLUDED
@@ -38,3 +38,155 @@ double XadcCore::read_fpga_vcc() {
 double XadcCore::read_fpga_temp() {
    return (read_adc_in(TMP_REG) * 503.975 - 273.15);
 }
+
+/* fixed-point versions: 12-bit reading scaled to Q16.16 (raw/4096) */
+q16_16_t XadcCore::read_adc_in_q(int n) {
+   return (raw2volt_q(read_raw(n) & 0xfff0));
+}
+
+q16_16_t XadcCore::read_fpga_vcc_q() {
+   return (raw2vcc_q(read_raw(VCC_REG) & 0xfff0));
+}
+
+q16_16_t XadcCore::read_fpga_temp_q() {
+   return (raw2temp_q(read_raw(TMP_REG) & 0xfff0));
+}
+
+// 16-bit reading/65536 is the Q16.16 value itself
+q16_16_t XadcCore::raw2volt_q(uint16_t raw) {
+   return (q16_16_t::from_raw(raw));
+}
+
+q16_16_t XadcCore::raw2vcc_q(uint16_t raw) {
+   return (raw2volt_q(raw) * 3);
+}
+
+q16_16_t XadcCore::raw2temp_q(uint16_t raw) {
+   constexpr q16_16_t TMP_GAIN = q16_16_t::from_double(503.975);
+   constexpr q16_16_t TMP_OFFSET = q16_16_t::from_double(273.15);
+
+   return (raw2volt_q(raw) * TMP_GAIN - TMP_OFFSET);
+}
+
+/**********************************************************************
+ * XadcScan
+ **********************************************************************/
+XadcScan::XadcScan(XadcCore *xadc) {
+   _xadc = xadc;
+   ch_mask = DEF_MASK;
+   period_us = DEF_PERIOD_US;
+   last_us = 0;
+   set_decimation(DEF_DECIM_BITS);
+}
+
+XadcScan::~XadcScan() {
+}
+
+// restart the decimation block: no stale partial sum of a channel
+// that was disabled, and no short block for one just enabled
+void XadcScan::set_channels(uint32_t mask) {
+   int i;
+
+   ch_mask = mask & ((1 << N_CH) - 1);
+   cnt = 0;
+   for (i = 0; i < N_CH; i++)
+      acc[i] = 0;
+   clear_minmax();
+}
+
+void XadcScan::set_period(int us) {
+   period_us = (us > 0) ? us : DEF_PERIOD_US;
+}
+
+void XadcScan::set_decimation(int bits) {
+   int i;
+
+   if (bits < 0)
+      bits = 0;
+   if (bits > 8)
+      bits = 8;
+   decim_bits = bits;
+   cnt = 0;
+   for (i = 0; i < N_CH; i++) {
+      acc[i] = 0;
+      avg[i] = 0;
+      val[i] = q16_16_t();
+   }
+   clear_minmax();
+}
+
+// zero until the next decimation block; update() then restarts them
+void XadcScan::clear_minmax() {
+   int i;
+
+   for (i = 0; i < N_CH; i++) {
+      min[i] = 0;
+      max[i] = 0;
+   }
+   valid = 0;
+}
+
+/*
+ * accumulate one raw sample per enabled channel;
+ * every 2^k scans: shift (no divide), update min/max, convert once
+ */
+void XadcScan::update() {
+   unsigned long now;
+   uint16_t a;
+   int i;
+
+   now = now_us();
+   if ((now - last_us) < period_us)
+      return;
+   last_us = now;
+   for (i = 0; i < N_CH; i++) {
+      if (bit_read(ch_mask, i))
+         acc[i] = acc[i] + _xadc->read_raw(i);
+   }
+   cnt++;
+   if (cnt < (1 << decim_bits))
+      return;
+   for (i = 0; i < N_CH; i++) {
+      if (!bit_read(ch_mask, i))
+         continue;
+      a = (uint16_t) (acc[i] >> decim_bits);
+      acc[i] = 0;
+      avg[i] = a;
+      if (!valid || a < min[i])
+         min[i] = a;
+      if (!valid || a > max[i])
+         max[i] = a;
+      if (i == XadcCore::TMP_REG)
+         val[i] = XadcCore::raw2temp_q(a);
+      else if (i == XadcCore::VCC_REG)
+         val[i] = XadcCore::raw2vcc_q(a);
+      else
+         val[i] = XadcCore::raw2volt_q(a);
+   }
+   cnt = 0;
+   valid = 1;
+}
+
+uint16_t XadcScan::read_avg(int n) {
+   return (avg[n]);
+}
+
+uint16_t XadcScan::read_min(int n) {
+   return (min[n]);
+}
+
+uint16_t XadcScan::read_max(int n) {
+   return (max[n]);
+}
+
+q16_16_t XadcScan::read_q(int n) {
+   return (val[n]);
+}
+
+q16_16_t XadcScan::read_fpga_temp_q() {
+   return (val[XadcCore::TMP_REG]);
+}
+
+q16_16_t XadcScan::read_fpga_vcc_q() {
+   return (val[XadcCore::VCC_REG]);
+}
@@ -12,6 +12,7 @@
 #define _XADC_CORE_H_INCLUDED
 
 #include "chu_init.h"
+#include "chu_fixed.h"
 
 /**
  * adsr core driver:
@@ -67,10 +68,164 @@ public:
     */
    double read_fpga_temp();
 
+   /**
+    * retrieve adc voltage in fixed-point format
+    *
+    * @param n adc input source (0 to 3)
+    * @return voltage between 0.0 and 1.0 in Q16.16
+    */
+   q16_16_t read_adc_in_q(int n);
+
+   /**
+    * retrieve FPGA internal vcc in fixed-point format
+    * @return FPGA core Vcc in Q16.16 (about 1.0V)
+    */
+   q16_16_t read_fpga_vcc_q();
+
+   /**
+    * retrieve FPGA internal temperature in fixed-point format
+    * @return FPGA core temperature in Celsius in Q16.16
+    */
+   q16_16_t read_fpga_temp_q();
+
+   /**
+    * convert a 16-bit adc reading to voltage
+    * @param raw 16-bit (MSB-justified) reading
+    * @return voltage between 0.0 and 1.0 in Q16.16
+    */
+   static q16_16_t raw2volt_q(uint16_t raw);
+
+   /**
+    * convert a 16-bit vcc channel reading to FPGA core vcc
+    * @param raw 16-bit (MSB-justified) reading
+    * @return FPGA core Vcc in Q16.16
+    */
+   static q16_16_t raw2vcc_q(uint16_t raw);
+
+   /**
+    * convert a 16-bit temperature channel reading to Celsius
+    * @param raw 16-bit (MSB-justified) reading
+    * @return FPGA core temperature in Celsius in Q16.16
+    */
+   static q16_16_t raw2temp_q(uint16_t raw);
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
 }
 ;
 
-#endif  // _XADC_CORE_H_INCLUDED
\ No newline at end of file
+/**********************************************************************
+ * xadc scan engine
+ **********************************************************************/
+/**
+ * xadc scan engine:
+ *  - poll a set of channels at a fixed period from the main loop
+ *  - average 2^k raw samples (decimation) per channel; the extra
+ *    bits below the 12-bit adc resolution are kept
+ *  - track min/max of the averaged values
+ *  - converted values are updated once per decimated output;
+ *    all read functions return cached data in constant time
+ */
+class XadcScan {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      N_CH = 6,              /**< # xadc channels (0-3: adc in; 4: temp; 5: vcc) */
+      DEF_MASK = 0x30,       /**< default channel set: temp and vcc */
+      DEF_PERIOD_US = 1000,  /**< default scan period */
+      DEF_DECIM_BITS = 4     /**< default: average 16 samples */
+   };
+
+   /**
+    * constructor.
+    * @param xadc pointer to xadc core instance
+    */
+   XadcScan(XadcCore *xadc);
+   ~XadcScan(); // not used
+
+   /**
+    * select channels to be scanned
+    * @param mask bit n enables channel n
+    */
+   void set_channels(uint32_t mask);
+
+   /**
+    * set scan period
+    * @param us period between two scans in microsecond
+    */
+   void set_period(int us);
+
+   /**
+    * set decimation ratio
+    * @param bits average 2^bits samples per output (0 to 8)
+    */
+   void set_decimation(int bits);
+
+   /**
+    * periodic task; read all enabled channels when the period elapses
+    */
+   void update();
+
+   /**
+    * clear min/max tracking
+    * @note min/max read 0 until the next decimation block ends
+    */
+   void clear_minmax();
+
+   /**
+    * averaged raw reading
+    * @param n channel (0 to 5)
+    * @return averaged 16-bit (MSB-justified) reading
+    */
+   uint16_t read_avg(int n);
+
+   /**
+    * min of averaged raw readings
+    * @param n channel (0 to 5)
+    */
+   uint16_t read_min(int n);
+
+   /**
+    * max of averaged raw readings
+    * @param n channel (0 to 5)
+    */
+   uint16_t read_max(int n);
+
+   /**
+    * cached converted reading
+    * @param n channel (0 to 5)
+    * @return volt (0-3), Celsius (4) or Vcc (5) in Q16.16
+    */
+   q16_16_t read_q(int n);
+
+   /**
+    * cached FPGA core temperature
+    * @return FPGA core temperature in Celsius in Q16.16
+    */
+   q16_16_t read_fpga_temp_q();
+
+   /**
+    * cached FPGA core vcc
+    * @return FPGA core Vcc in Q16.16
+    */
+   q16_16_t read_fpga_vcc_q();
+
+private:
+   XadcCore *_xadc;
+   uint32_t ch_mask;
+   unsigned long period_us;
+   unsigned long last_us;
+   int decim_bits;
+   int cnt;                   // # samples in accumulators
+   uint32_t acc[N_CH];        // accumulated raw samples
+   uint16_t avg[N_CH];
+   uint16_t min[N_CH];
+   uint16_t max[N_CH];
+   q16_16_t val[N_CH];
+   int valid;                 // min/max hold data
+};
+
+#endif  // _XADC_CORE_H_INCLUDED
@@ -1,5 +1,25 @@
+//
+//  Reg map (each port uses 8 address space)
+//    * 0: read data and status
+//    * 1: write ss_n register
+//    * 2: write data (push into tx FIFO)
+//    * 3: write control register (cpha/cpol/dvsr)
+//    * 4: dummy write to remove data from head of rx FIFO
+//
+//  Read data/status word
+//    * bits 7-0: head of rx FIFO
+//    * bit 8: ready (tx FIFO empty and spi shifter idle)
+//    * bit 9: rx FIFO empty
+//    * bit 10: tx FIFO full
+//
+//  The tx FIFO feeds the shifter back-to-back; each received byte is
+//  pushed into the rx FIFO so the processor can queue the next byte
+//  while the current one is still shifting
+//
 module chu_spi_core
-   #(parameter S = 2)  // width (# bits) of output port
+   #(parameter S = 2,  // width (# bits) of output port
+               F = 2   // # addr bits of tx/rx FIFO
+   )
    (
     input  logic clk,
     input  logic reset,
@@ -10,43 +30,64 @@ module chu_spi_core
     input  logic [4:0] addr,
     input  logic [31:0] wr_data,
     output logic [31:0] rd_data,
-    // external signal    
+    // external signal
     output logic spi_sclk,
     output logic spi_mosi,
     input  logic spi_miso,
-    output logic [S-1:0] spi_ss_n 
+    output logic [S-1:0] spi_ss_n
    );
 
    // signal declaration
-   logic wr_en, wr_ss, wr_spi, wr_ctrl;
+   logic wr_en, wr_ss, wr_spi, wr_ctrl, rm_rx;
    logic [17:0] ctrl_reg;
    logic [S-1:0] ss_n_reg;
-   logic [7:0] spi_out;
-   logic spi_ready, cpol, cpha; 
+   logic [7:0] spi_out, tx_data, rx_data;
+   logic spi_ready, spi_done_tick, cpol, cpha;
+   logic tx_empty, tx_full, tx_rd, rx_empty, rx_rd;
    logic [15:0] dvsr;
-   
+
    // instantiate spi controller
    spi spi_unit(
-    .clk(clk), .reset(reset), 
-    .din(wr_data[7:0]),
+    .clk(clk), .reset(reset),
+    .din(tx_data),
     .dvsr(dvsr),
-    .start(wr_spi),
+    .start(tx_rd),
     .cpol(cpol),
     .cpha(cpha),
     .dout(spi_out),
     .sclk(spi_sclk),
     .miso(spi_miso),
     .mosi(spi_mosi),
-    .spi_done_tick(),
+    .spi_done_tick(spi_done_tick),
     .ready(spi_ready)
    );
-       
+
+   // instantiate tx FIFO; head byte starts the shifter when it is idle
+   fifo #(.DATA_WIDTH(8), .ADDR_WIDTH(F)) tx_fifo_unit (
+    .clk(clk), .reset(reset),
+    .rd(tx_rd), .wr(wr_spi),
+    .w_data(wr_data[7:0]),
+    .empty(tx_empty), .full(tx_full),
+    .r_data(tx_data)
+   );
+   assign tx_rd = spi_ready & ~tx_empty;
+
+   // instantiate rx FIFO; received byte pushed at the end of each transfer
+   fifo #(.DATA_WIDTH(8), .ADDR_WIDTH(F)) rx_fifo_unit (
+    .clk(clk), .reset(reset),
+    .rd(rx_rd), .wr(spi_done_tick),
+    .w_data(spi_out),
+    .empty(rx_empty), .full(),
+    .r_data(rx_data)
+   );
+   assign rx_rd = rm_rx & ~rx_empty;
+
    // registers
    always_ff @(posedge clk, posedge reset)
       if (reset) begin
-         ctrl_reg <= 17'h0_0200;    // dvsr=1028 (about 50 KHz sclk for 100MHz clk)  
+         ctrl_reg <= 17'h0_0200;    // dvsr=1028 (about 50 KHz sclk for 100MHz clk)
          ss_n_reg <= {S{1'b1}};     // de-assert all ss_n
-      end 
+      end
       else begin
          if (wr_ctrl)
              ctrl_reg <= wr_data[17:0];
@@ -55,14 +96,16 @@ module chu_spi_core
       end
    // decoding
    assign wr_en = cs & write ;
-   assign wr_ss = wr_en && addr[1:0]==2'b01;
-   assign wr_spi = wr_en && addr[1:0]==2'b10;
-   assign wr_ctrl = wr_en && addr[1:0]==2'b11;
-   // control signals 
+   assign wr_ss = wr_en && addr[2:0]==3'b001;
+   assign wr_spi = wr_en && addr[2:0]==3'b010;
+   assign wr_ctrl = wr_en && addr[2:0]==3'b011;
+   assign rm_rx = wr_en && addr[2:0]==3'b100;
+   // control signals
    assign dvsr = ctrl_reg[15:0];
    assign cpol = ctrl_reg[16];
    assign cpha = ctrl_reg[17];
    assign spi_ss_n = ss_n_reg;
-   // read multiplexing 
-   assign  rd_data = {23'b0, spi_ready, spi_out};
-endmodule  
+   // read multiplexing
+   assign  rd_data = {21'b0, tx_full, rx_empty, spi_ready & tx_empty, rx_data};
+endmodule
+
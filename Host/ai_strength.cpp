@@ -0,0 +1,88 @@
+/*****************************************************************//**
+ * @file ai_strength.cpp
+ *
+ * @brief play the cpu ai against a random player on the host
+ *
+ * Usage:
+ *    ai_strength [# battles] [budget us | -depth] [seed]
+ *
+ *  - build:
+ *      g++ -O2 -IApplication Host/ai_strength.cpp Application/battle.cpp
+ *          Application/pokedex.cpp Application/battle_ai.cpp
+ *          -o ai_strength
+ *  - each battle: random 1-6 member parties of equal size; the
+ *    player picks a random legal action, the cpu asks BattleAi
+ *  - budget: search time per turn in us (host clock; default
+ *    2000); a negative value searches to a fixed depth instead,
+ *    which gives the same result on any host
+ *  - prints ai wins, random wins, draws (MAX_TURNS reached), the
+ *    average search depth and nodes per turn
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "battle_ai.h"
+
+enum {
+   DEF_BATTLES = 200,
+   DEF_BUDGET_US = 2000,
+   MAX_TURNS = 400
+};
+
+static unsigned long host_us() {
+   return ((unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static int random_action(const BattleState &st, int s, Prng &rng) {
+   int a;
+
+   do {
+      a = rng.below(N_ACTIONS);
+   } while (!st.legal(s, a));
+   return (a);
+}
+
+int main(int argc, char *argv[]) {
+   uint8_t team[2][Party::MAX_MEMBERS];
+   long battles, g, wins[2] = { 0, 0 }, draws = 0;
+   unsigned long long turns = 0, depth_sum = 0, node_sum = 0;
+   BattleAi ai(host_us);
+   BattleLog log;
+   long budget;
+   int n, m, s, act;
+
+   battles = (argc > 1) ? atol(argv[1]) : (long) DEF_BATTLES;
+   budget = (argc > 2) ? atol(argv[2]) : (long) DEF_BUDGET_US;
+   Prng rng((argc > 3) ? (uint32_t) strtoul(argv[3], 0, 0) : 1);
+   if (budget < 0)
+      ai.set_depth((int) -budget);
+   else
+      ai.set_budget((unsigned long) budget);
+   for (g = 0; g < battles; g++) {
+      n = rng.range(1, Party::MAX_MEMBERS);
+      for (s = 0; s < 2; s++)
+         for (m = 0; m < n; m++)
+            team[s][m] = (uint8_t) rng.below(N_SPECIES);
+      BattleState st(team[0], n, team[1], n);
+      while (!st.over() && st.turn < MAX_TURNS) {
+         act = ai.choose(st);
+         depth_sum += ai.depth();
+         node_sum += ai.nodes();
+         turns++;
+         battle_step(st, random_action(st, BattleState::PLAYER, rng), act, rng, log);
+      }
+      if (st.over())
+         wins[st.winner]++;
+      else
+         draws++;
+   }
+   printf("battles %ld  ai wins %ld  random wins %ld  draws %ld\n", battles,
+          wins[BattleState::CPU], wins[BattleState::PLAYER], draws);
+   if (turns > 0)
+      printf("turns %llu  avg depth %.2f  avg nodes %.0f\n", turns,
+             (double) depth_sum / turns, (double) node_sum / turns);
+   return (0);
+}
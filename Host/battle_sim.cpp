@@ -0,0 +1,94 @@
+/*****************************************************************//**
+ * @file battle_sim.cpp
+ *
+ * @brief run many random battles through the headless engine and
+ *        check the battle invariants after every turn
+ *
+ * Usage:
+ *    battle_sim [# battles] [seed]
+ *
+ *  - build:
+ *      g++ -O2 -IApplication Host/battle_sim.cpp Application/battle.cpp
+ *          Application/pokedex.cpp Application/battle_ai.cpp
+ *          -o battle_sim
+ *  - each battle: two random 1-6 member parties, both sides pick a
+ *    random legal action each turn; battle_check() runs after every
+ *    battle_step()
+ *  - a battle still running after MAX_TURNS is counted as a draw
+ *  - prints turns/sec of the engine, win/draw counts and the # turns
+ *    that violated each CHK_xxx bit; exit code 1 on any violation
+ *  - same battles for the same seed on any host
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "battle_ai.h"
+
+enum {
+   DEF_BATTLES = 1000000,
+   MAX_TURNS = 500,
+   N_CHK_BITS = 7
+};
+
+static const char *const CHK_NAME[N_CHK_BITS] = {
+   "party", "hp", "faint", "stage", "active", "winner", "species"
+};
+
+static void random_team(uint8_t *team, int *n, Prng &rng) {
+   *n = rng.range(1, Party::MAX_MEMBERS);
+   for (int m = 0; m < *n; m++)
+      team[m] = (uint8_t) rng.below(N_SPECIES);
+}
+
+static int random_action(const BattleState &st, int s, Prng &rng) {
+   int a;
+
+   do {
+      a = rng.below(N_ACTIONS);
+   } while (!st.legal(s, a));
+   return (a);
+}
+
+int main(int argc, char *argv[]) {
+   uint8_t team[2][Party::MAX_MEMBERS];
+   unsigned long long turns = 0, bad_turns = 0, chk_count[N_CHK_BITS] = { 0 };
+   long battles, g, wins[2] = { 0, 0 }, draws = 0;
+   std::chrono::steady_clock::time_point t0;
+   double sec;
+   BattleLog log;
+   int n[2], bad, b;
+
+   battles = (argc > 1) ? atol(argv[1]) : (long) DEF_BATTLES;
+   Prng rng((argc > 2) ? (uint32_t) strtoul(argv[2], 0, 0) : 1);
+   t0 = std::chrono::steady_clock::now();
+   for (g = 0; g < battles; g++) {
+      random_team(team[0], &n[0], rng);
+      random_team(team[1], &n[1], rng);
+      BattleState st(team[0], n[0], team[1], n[1]);
+      while (!st.over() && st.turn < MAX_TURNS) {
+         battle_step(st, random_action(st, BattleState::PLAYER, rng),
+               random_action(st, BattleState::CPU, rng), rng, log);
+         turns++;
+         bad = battle_check(st);
+         if (bad == 0)
+            continue;
+         bad_turns++;
+         for (b = 0; b < N_CHK_BITS; b++)
+            chk_count[b] += (bad >> b) & 1;
+      }
+      if (st.over())
+         wins[st.winner]++;
+      else
+         draws++;
+   }
+   sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+   printf("battles %ld  turns %llu  %.2f s  %.0f turns/s (incl. random picks and checks)\n",
+          battles, turns, sec, turns / sec);
+   printf("player wins %ld  cpu wins %ld  draws %ld\n", wins[0], wins[1], draws);
+   printf("turns with violations %llu\n", bad_turns);
+   for (b = 0; b < N_CHK_BITS; b++)
+      printf("  %-8s %llu\n", CHK_NAME[b], chk_count[b]);
+   return (bad_turns > 0);
+}
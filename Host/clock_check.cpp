@@ -0,0 +1,64 @@
+/*****************************************************************//**
+ * @file clock_check.cpp
+ *
+ * @brief check the virtual clock of the host timer model
+ *
+ * Usage:
+ *    clock_check [rd_cycles wr_cycles]
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost
+ *          Host/clock_check.cpp Host/host_io.cpp Host/video_model.cpp
+ *          Driver/chu_init.cpp Driver/timer_core.cpp
+ *          Driver/uart_core.cpp -o clock_check
+ *  - in virtual clock mode, each sleep_us()/sleep_ms() must move
+ *    now_us() ahead by the sleep plus the io cycles charged while
+ *    sleeping and reading the clock (within 1 us of rounding), and
+ *    must take far less wall time than it simulates
+ *  - prints one line per case; exit code 1 on any failure
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "host_io.h"
+#include "chu_init.h"
+
+int main(int argc, char *argv[]) {
+   static const unsigned long SLEEP_US[] = { 0, 1, 7, 1000, 250000, 60000000 };
+   std::chrono::steady_clock::time_point t0;
+   unsigned long a, b, want, total_us = 0;
+   double wall_us;
+   int i, bad = 0;
+
+   if (argc > 2)
+      host_io_set_cost(atoi(argv[1]), atoi(argv[2]));
+   host_io_virtual_clock(1);
+   t0 = std::chrono::steady_clock::now();
+   for (i = 0; i < (int) (sizeof(SLEEP_US) / sizeof(SLEEP_US[0])); i++) {
+      a = now_us();
+      host_io_reset_count();
+      if (SLEEP_US[i] % 1000 == 0)
+         sleep_ms(SLEEP_US[i] / 1000);
+      else
+         sleep_us(SLEEP_US[i]);
+      b = now_us();
+      // charged cycles include the reads of b, not the reads of a
+      want = SLEEP_US[i] + (unsigned long) (host_io_cycles() / SYS_CLK_FREQ);
+      total_us = total_us + (b - a);
+      printf("sleep %9lu us: clock +%9lu us, expected %9lu us (%lu io reads)\n",
+             SLEEP_US[i], b - a, want, host_io_reads());
+      if (b - a + 1 < want || b - a > want + 1) {
+         printf("  FAIL\n");
+         bad++;
+      }
+   }
+   wall_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+   printf("simulated %lu us in %.0f us wall time\n", total_us, wall_us);
+   if (wall_us * 100 > total_us) {
+      printf("FAIL: virtual clock not faster than real time\n");
+      bad++;
+   }
+   return (bad > 0);
+}
@@ -0,0 +1,68 @@
+/*****************************************************************//**
+ * @file damage_bench.cpp
+ *
+ * @brief host timing of the integer damage formula
+ *
+ * Usage:
+ *    damage_bench [# passes]
+ *
+ *  - build:
+ *      g++ -O2 -IApplication Host/damage_bench.cpp
+ *          Application/pokedex.cpp -o damage_bench
+ *  - one pass: calc_damage() for every attacker/defender species
+ *    pair, every damaging move, attack stages -6 to +6 and 8 rolls
+ *    between ROLL_MIN and ROLL_MAX
+ *  - prints # calculations, calculations/s and a checksum of all
+ *    results; for the same # passes the checksum changes only when
+ *    the formula does
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "pokedex.h"
+
+enum {
+   DEF_PASSES = 100,
+   N_ROLLS = 8
+};
+
+int main(int argc, char *argv[]) {
+   uint8_t moves[N_MOVES];
+   std::chrono::steady_clock::time_point t0;
+   unsigned long long calcs = 0;
+   uint32_t sum = 0;
+   double sec;
+   int passes, p, a, d, m, n_moves, st, r, roll;
+
+   passes = (argc > 1) ? atoi(argv[1]) : (int) DEF_PASSES;
+   for (m = 0, n_moves = 0; m < N_MOVES; m++)
+      if (move_info(m).effect == EFF_DAMAGE && move_info(m).power > 0)
+         moves[n_moves++] = (uint8_t) m;
+   t0 = std::chrono::steady_clock::now();
+   for (p = 0; p < passes; p++) {
+      for (a = 0; a < N_SPECIES; a++) {
+         uint8_t sa = (uint8_t) a;
+         Party user(&sa, 1);
+         for (d = 0; d < N_SPECIES; d++) {
+            uint8_t sd = (uint8_t) d;
+            Party target(&sd, 1);
+            for (st = -MAX_STAGE; st <= MAX_STAGE; st++) {
+               user.atk_stage[0] = (int8_t) st;
+               for (m = 0; m < n_moves; m++) {
+                  for (r = 0; r < N_ROLLS; r++) {
+                     roll = ROLL_MIN + r * (ROLL_MAX - ROLL_MIN) / (N_ROLLS - 1);
+                     sum = sum * 31 + (uint32_t) calc_damage(user, moves[m], target, roll);
+                     calcs++;
+                  }
+               }
+            }
+         }
+      }
+   }
+   sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+   printf("calcs %llu  %.3f s  %.1f M calcs/s  checksum %08x\n", calcs, sec,
+          calcs / sec / 1e6, (unsigned) sum);
+   return (0);
+}
@@ -0,0 +1,204 @@
+/*****************************************************************//**
+ * @file draw_check.cpp
+ *
+ * @brief pixel hashes, write counts and timing of the FrameCore
+ *        drawing primitives on the host video model
+ *
+ * Usage:
+ *    draw_check [reference table | -]
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost -IApplication
+ *          Host/draw_check.cpp Host/video_model.cpp Host/host_io.cpp
+ *          Driver/vga_core.cpp Application/scene.cpp -o draw_check
+ *  - each case starts from a cleared frame buffer and draws a fixed
+ *    set of calls (the last case is the game's battle background,
+ *    environmentInit() of Application/scene.cpp)
+ *  - prints one line per case: name, # io writes, us per run and
+ *    the hash of the resulting frame buffer
+ *  - the hashes are compared with the reference table, by default
+ *    Host/draw_check.ref (run from the repository root); cases whose
+ *    hash differs or is missing are reported and the exit code is 1;
+ *    an optimization of a primitive must keep every hash
+ *  - "-" skips the comparison
+ *  - reference lines: name and hash as the last field, so a saved
+ *    output works as well; "#" starts a comment line
+ *  - the hashes do not depend on the host; update the table only
+ *    for an intended change of pixels:
+ *      draw_check - | awk '{print $1, $4}'
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include "host_io.h"
+#include "video_model.h"
+#include "vga_core.h"
+#include "scene.h"
+
+#define DEF_REF "Host/draw_check.ref"
+
+enum {
+   MAX_CASES = 32,
+   MIN_US = 20000   // time each case for at least 20 ms
+};
+
+typedef void (*draw_fn)(FrameCore *f);
+
+struct DrawCase {
+   const char *name;
+   draw_fn draw;
+};
+
+static void pix(FrameCore *f) {
+   for (int i = 0; i < 64; i++)
+      f->wr_pix(i * 7 % 640, i * 13 % 480, i * 8);
+}
+
+static void clr(FrameCore *f) {
+   f->clr_screen(0xfff);
+}
+
+static void lines(FrameCore *f) {
+   f->plot_line(0, 0, 639, 479, 0x1c0);    // shallow
+   f->plot_line(639, 0, 0, 479, 0x038);    // reversed
+   f->plot_line(320, 0, 330, 479, 0x007);  // steep
+   f->plot_line(10, 200, 600, 200, 0x1ff); // horizontal
+   f->plot_line(100, 470, 100, 10, 0x092); // vertical, upward
+}
+
+static void fast_lines(FrameCore *f) {
+   f->drawFastHLine(5, 5, 630, 0x1c0);
+   f->drawFastVLine(5, 5, 470, 0x038);
+}
+
+static void rect(FrameCore *f) {
+   f->fillRect(0, 380, 640, 100, 0x000);
+   f->fillRect(100, 100, 50, 30, 0x16d);
+}
+
+static void circle(FrameCore *f) {
+   f->fillCircle(320, 240, 100, 0x1c0);
+   f->fillCircle(20, 20, 5, 0x007);
+   f->fillCircle(600, 400, 0, 0x038);
+}
+
+static void circle_helper(FrameCore *f) {
+   f->fillCircleHelper(160, 120, 40, 1, 0, 0x1c0);
+   f->fillCircleHelper(480, 120, 40, 2, 20, 0x038);
+   f->fillCircleHelper(320, 360, 40, 3, 10, 0x007);
+}
+
+static void round_rect(FrameCore *f) {
+   f->fillRoundRect(10, 385, 620, 95, 20, 0xfff);
+   f->fillRoundRect(3, 40, 240, 80, 20, 0x000);
+}
+
+// radius far larger than the box: clipped to half the minor axis
+static void round_rect_big(FrameCore *f) {
+   f->fillRoundRect(-50, 300, 400, 150, 600, 0x092);
+   f->fillRoundRect(330, 130, 300, 90, 600, 0x092);
+   f->fillRoundRect(340, 135, 280, 80, 200, 0x0db);
+}
+
+static const DrawCase CASES[] = {
+   { "wr_pix", pix },
+   { "clr_screen", clr },
+   { "plot_line", lines },
+   { "fast_lines", fast_lines },
+   { "fillRect", rect },
+   { "fillCircle", circle },
+   { "fillCircleHelper", circle_helper },
+   { "fillRoundRect", round_rect },
+   { "fillRoundRect_big_r", round_rect_big },
+   { "environmentInit", environmentInit }
+};
+static const int N_CASES = sizeof(CASES) / sizeof(CASES[0]);
+
+static VideoModel model;
+
+// read "name hash" or "name writes us hash" lines
+static int load_ref(const char *path, char names[][64], unsigned long long *hash) {
+   FILE *f;
+   char line[256], *last;
+   int n = 0;
+
+   f = fopen(path, "r");
+   if (!f)
+      return (-1);
+   while (n < MAX_CASES && fgets(line, sizeof(line), f)) {
+      if (line[0] == '#' || sscanf(line, "%63s", names[n]) != 1)
+         continue;
+      last = line + strlen(line);
+      while (last > line && strchr(" \t\r\n", last[-1]))
+         last--;
+      *last = 0;
+      while (last > line && !strchr(" \t", last[-1]))
+         last--;
+      if (last == line || sscanf(last, "%llx", &hash[n]) != 1)
+         continue;   // no hash field
+      n++;
+   }
+   fclose(f);
+   return (n);
+}
+
+static double run_us(FrameCore *f, draw_fn draw) {
+   std::chrono::steady_clock::time_point t0;
+   double us;
+   long runs = 0;
+
+   t0 = std::chrono::steady_clock::now();
+   do {
+      draw(f);
+      runs++;
+      us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+   } while (us < MIN_US);
+   return (us / runs);
+}
+
+int main(int argc, char *argv[]) {
+   char ref_name[MAX_CASES][64];
+   unsigned long long ref_hash[MAX_CASES], h;
+   unsigned long writes;
+   double us;
+   const char *ref = (argc > 1) ? argv[1] : DEF_REF;
+   int n_ref = 0, bad = 0, check, i, r, found;
+
+   check = (strcmp(ref, "-") != 0);
+   if (check) {
+      n_ref = load_ref(ref, ref_name, ref_hash);
+      if (n_ref < 0) {
+         fprintf(stderr, "cannot read %s\n", ref);
+         return (1);
+      }
+   }
+   host_io_attach_video(&model);
+   FrameCore frame(FRAME_BASE);
+   for (i = 0; i < N_CASES; i++) {
+      model.clear_frame();
+      host_io_reset_count();
+      CASES[i].draw(&frame);
+      writes = host_io_writes();
+      h = model.frame_hash();
+      us = run_us(&frame, CASES[i].draw);
+      printf("%-20s %8lu %10.1f %016llx\n", CASES[i].name, writes, us, h);
+      if (!check)
+         continue;
+      for (r = 0, found = 0; r < n_ref; r++) {
+         if (strcmp(ref_name[r], CASES[i].name) != 0)
+            continue;
+         found = 1;
+         if (ref_hash[r] != h) {
+            fprintf(stderr, "%s: pixels differ from the reference\n", CASES[i].name);
+            bad++;
+         }
+      }
+      if (!found) {
+         fprintf(stderr, "%s: not in the reference\n", CASES[i].name);
+         bad++;
+      }
+   }
+   return (bad > 0);
+}
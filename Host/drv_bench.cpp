@@ -0,0 +1,171 @@
+/*****************************************************************//**
+ * @file drv_bench.cpp
+ *
+ * @brief host timing of the hot driver calls with an estimate of
+ *        their io cost on the board
+ *
+ * Usage:
+ *    drv_bench [rd_cycles wr_cycles]
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost
+ *          Host/drv_bench.cpp Host/video_model.cpp Host/host_io.cpp
+ *          Driver/vga_core.cpp Driver/uart_core.cpp
+ *          Driver/spi_core.cpp -o drv_bench
+ *  - rd_cycles/wr_cycles: system clock cycles charged per io
+ *    read/write (default: host_io.cpp values)
+ *  - output: one tab-separated line per call after a header line:
+ *      name, io reads, io writes, host ns, board io us
+ *    counts and costs are per call; "board io us" is the io bus
+ *    time at SYS_CLK_FREQ only (a lower bound: cpu time between
+ *    accesses is not modeled)
+ *  - save the table per commit and diff it to spot regressions
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "host_io.h"
+#include "video_model.h"
+#include "vga_core.h"
+#include "uart_core.h"
+#include "spi_core.h"
+
+enum {
+   MIN_NS = 20000000   // time each call for at least 20 ms
+};
+
+typedef void (*bench_fn)();
+
+struct BenchCase {
+   const char *name;
+   bench_fn run;
+};
+
+static VideoModel model;
+static FrameCore *frame;
+static OsdCore *osd;
+static SpriteCore *sprite;
+static UartCore *uart_p;
+static SpiCore *spi;
+static uint8_t spi_tx[64], spi_rx[64];
+
+static void b_wr_pix() {
+   frame->wr_pix(320, 240, 0x1ff);
+}
+
+static void b_clr_screen() {
+   frame->clr_screen(0xfff);
+}
+
+static void b_fill_rect() {
+   frame->fillRect(0, 380, 640, 100, 0x000);
+}
+
+static void b_plot_line() {
+   frame->plot_line(0, 0, 639, 479, 0x1c0);
+}
+
+static void b_wr_char() {
+   osd->wr_char(10, 5, 'A');
+}
+
+static void b_osd_clr() {
+   osd->clr_screen();
+}
+
+static void b_move_xy() {
+   sprite->move_xy(100, 200);
+}
+
+static void b_disp_str() {
+   uart_p->disp("snorlax used body slam\n\r");
+}
+
+static void b_disp_char() {
+   uart_p->disp('x');
+}
+
+static void b_disp_int() {
+   uart_p->disp(-123456);
+}
+
+static void b_disp_hex() {
+   uart_p->disp(0x1234abcd, 16, 8);
+}
+
+static void b_disp_double() {
+   uart_p->disp(3.14159, 3);
+}
+
+static void b_spi_byte() {
+   spi->transfer(0xa5);
+}
+
+static void b_spi_block() {
+   spi->transfer(spi_tx, spi_rx, sizeof(spi_tx), 0);
+}
+
+static const BenchCase CASES[] = {
+   { "FrameCore::wr_pix", b_wr_pix },
+   { "FrameCore::clr_screen", b_clr_screen },
+   { "FrameCore::fillRect_640x100", b_fill_rect },
+   { "FrameCore::plot_line_diag", b_plot_line },
+   { "OsdCore::wr_char", b_wr_char },
+   { "OsdCore::clr_screen", b_osd_clr },
+   { "SpriteCore::move_xy", b_move_xy },
+   { "UartCore::disp_str_24", b_disp_str },
+   { "UartCore::disp_char", b_disp_char },
+   { "UartCore::disp_int", b_disp_int },
+   { "UartCore::disp_hex8", b_disp_hex },
+   { "UartCore::disp_double3", b_disp_double },
+   { "SpiCore::transfer_byte", b_spi_byte },
+   { "SpiCore::transfer_64", b_spi_block }
+};
+static const int N_CASES = sizeof(CASES) / sizeof(CASES[0]);
+
+static double run_ns(bench_fn run) {
+   std::chrono::steady_clock::time_point t0;
+   double ns;
+   long runs = 0;
+
+   t0 = std::chrono::steady_clock::now();
+   do {
+      run();
+      runs++;
+      ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+   } while (ns < MIN_NS);
+   return (ns / runs);
+}
+
+int main(int argc, char *argv[]) {
+   unsigned long rd, wr;
+   unsigned long long cyc;
+   int i;
+
+   if (argc > 2)
+      host_io_set_cost(atoi(argv[1]), atoi(argv[2]));
+   host_io_attach_video(&model);
+   FrameCore frame_core(FRAME_BASE);
+   OsdCore osd_core(get_sprite_addr(BRIDGE_BASE, V2_OSD));
+   SpriteCore sprite_core(get_sprite_addr(BRIDGE_BASE, V1_MOUSE), 16384);
+   UartCore uart_core(get_slot_addr(BRIDGE_BASE, UART_SLOT));
+   SpiCore spi_core(get_slot_addr(BRIDGE_BASE, S9_SPI));
+   frame = &frame_core;
+   osd = &osd_core;
+   sprite = &sprite_core;
+   uart_p = &uart_core;
+   spi = &spi_core;
+   printf("name\tio_rd\tio_wr\thost_ns\tboard_io_us\n");
+   for (i = 0; i < N_CASES; i++) {
+      host_io_reset_count();
+      CASES[i].run();
+      rd = host_io_reads();
+      wr = host_io_writes();
+      cyc = host_io_cycles();
+      printf("%s\t%lu\t%lu\t%.1f\t%.3f\n", CASES[i].name, rd, wr,
+             run_ns(CASES[i].run), (double) cyc / SYS_CLK_FREQ);
+   }
+   return (0);
+}
@@ -0,0 +1,142 @@
+/*****************************************************************//**
+ * @file host_io.cpp
+ *
+ * @brief implementation of the host io hooks
+ *
+ * Description:
+ *  - byte address to word address relative to BRIDGE_BASE;
+ *    word bit 21 selects the video subsystem (chu_mcs_bridge.sv)
+ *
+ ********************************************************************/
+
+#include <chrono>
+#include "host_io.h"
+#include "chu_io_map.h"
+#include "video_model.h"
+
+enum {
+   N_SLOTS = 64,
+   SLOT_WORDS = 32,
+   VIDEO_BIT = 1 << 21,
+   DEF_RD_CYCLES = 8,   // mcs io bus read incl. bridge latency
+   DEF_WR_CYCLES = 4,
+   TIMER_CTRL = 2,      // TimerCore::CTRL_REG
+   TIMER_GO = 1,
+   TIMER_CLR = 2
+};
+
+static VideoModel *video = 0;
+static uint32_t regs[N_SLOTS * SLOT_WORDS];
+static unsigned long n_reads = 0;
+static unsigned long n_writes = 0;
+static unsigned long long cycles = 0;
+static int rd_cost = DEF_RD_CYCLES;
+static int wr_cost = DEF_WR_CYCLES;
+
+// system timer (chu_timer.sv): 48-bit count of system clocks
+static int virtual_clock = 0;
+static uint64_t vclock = 0;       // virtual time in system clocks
+static uint64_t timer_count = 0;
+static uint64_t timer_last = 0;   // time base at the last update
+static int timer_go = 0;
+
+// current time base in system clocks
+static uint64_t clock_now() {
+   static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+   std::chrono::steady_clock::duration d;
+
+   if (virtual_clock)
+      return (vclock);
+   d = std::chrono::steady_clock::now() - t0;
+   return ((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() * SYS_CLK_FREQ / 1000);
+}
+
+static void timer_update() {
+   uint64_t now = clock_now();
+
+   if (timer_go)
+      timer_count = (timer_count + (now - timer_last)) & 0xffffffffffffull;
+   timer_last = now;
+}
+
+static uint32_t timer_read(uint32_t reg) {
+   timer_update();
+   return ((reg & 1) ? (uint32_t) (timer_count >> 32) : (uint32_t) timer_count);
+}
+
+static void timer_write(uint32_t reg, uint32_t data) {
+   if ((reg & 3) != TIMER_CTRL)
+      return;
+   timer_update();
+   if (data & TIMER_CLR)
+      timer_count = 0;
+   timer_go = data & TIMER_GO;
+}
+
+void host_io_attach_video(VideoModel *v) {
+   video = v;
+}
+
+void host_io_set_cost(int rd_cycles, int wr_cycles) {
+   rd_cost = rd_cycles;
+   wr_cost = wr_cycles;
+}
+
+void host_io_virtual_clock(int on) {
+   timer_update();
+   virtual_clock = on;
+   timer_last = clock_now();
+}
+
+void host_io_idle(uint64_t us) {
+   if (virtual_clock)
+      vclock = vclock + us * SYS_CLK_FREQ;
+}
+
+unsigned long host_io_reads() {
+   return (n_reads);
+}
+
+unsigned long host_io_writes() {
+   return (n_writes);
+}
+
+unsigned long long host_io_cycles() {
+   return (cycles);
+}
+
+void host_io_reset_count() {
+   n_reads = 0;
+   n_writes = 0;
+   cycles = 0;
+}
+
+uint32_t host_io_read(uint32_t addr) {
+   uint32_t w = (addr - BRIDGE_BASE) >> 2;
+
+   n_reads++;
+   cycles = cycles + rd_cost;
+   vclock = vclock + rd_cost;
+   if (w & VIDEO_BIT)
+      return (0);   // video cores are write-only
+   if (w / SLOT_WORDS == S0_SYS_TIMER)
+      return (timer_read(w % SLOT_WORDS));
+   return ((w < N_SLOTS * SLOT_WORDS) ? regs[w] : 0);
+}
+
+void host_io_write(uint32_t addr, uint32_t data) {
+   uint32_t w = (addr - BRIDGE_BASE) >> 2;
+
+   n_writes++;
+   cycles = cycles + wr_cost;
+   vclock = vclock + wr_cost;
+   if (w & VIDEO_BIT) {
+      if (video)
+         video->write(w & (VIDEO_BIT - 1), data);
+      return;
+   }
+   if (w / SLOT_WORDS == S0_SYS_TIMER)
+      timer_write(w % SLOT_WORDS, data);
+   else if (w < N_SLOTS * SLOT_WORDS)
+      regs[w] = data;
+}
@@ -0,0 +1,119 @@
+/*****************************************************************//**
+ * @file host_io.h
+ *
+ * @brief io access hooks to run the drivers on the host
+ *
+ * Description:
+ *  - replaces the io_read()/io_write() macros of chu_io_rw.h
+ *    (through _VENDOR_IO_ACCESS_USED) with calls into a host model
+ *  - force-include it when compiling the drivers on the host:
+ *       g++ -include Host/host_io.h -IDriver -IHost ...
+ *  - the video address space goes to an attached VideoModel;
+ *    the io slots are plain register files (read back what was
+ *    written)
+ *  - every access is counted and charged a configurable # of
+ *    system clock cycles (cost of an access over the mcs io bus)
+ *  - the system timer (slot 0) is modeled: its counter follows the
+ *    wall clock, or in virtual clock mode only the charged io cycles
+ *    plus idle time; TimerCore::sleep() then returns at once with
+ *    the clock moved ahead, so sleep-heavy code runs faster than real
+ *    time with realistic timestamps
+ *
+ *********************************************************************/
+
+#ifndef _HOST_IO_H_INCLUDED
+#define _HOST_IO_H_INCLUDED
+
+#include <inttypes.h>
+
+#define _VENDOR_IO_ACCESS_USED
+
+#define io_read(base_addr, offset) \
+   host_io_read((uint32_t) ((base_addr) + 4*(offset)))
+
+#define io_write(base_addr, offset, data) \
+   host_io_write((uint32_t) ((base_addr) + 4*(offset)), (uint32_t) (data))
+
+// busy wait hint used by TimerCore::sleep()
+#define io_idle(base_addr, us) \
+   host_io_idle((uint64_t) (us))
+
+#ifdef __cplusplus
+class VideoModel;
+
+/**
+ * route the video address space to a model
+ *
+ * @param v pointer to model instance (0: video writes are dropped)
+ * @note attach before constructing the video cores; their
+ *       constructors already write registers
+ *
+ */
+void host_io_attach_video(VideoModel *v);
+
+/**
+ * set the cost model of an io access
+ *
+ * @param rd_cycles system clock cycles per io read
+ * @param wr_cycles system clock cycles per io write
+ *
+ */
+void host_io_set_cost(int rd_cycles, int wr_cycles);
+
+/**
+ * select the time base of the system timer
+ *
+ * @param on 1: virtual clock (io cycles plus idle time);
+ *        0: wall clock (default)
+ *
+ */
+void host_io_virtual_clock(int on);
+
+/**
+ * # io reads/writes since the last reset
+ *
+ */
+unsigned long host_io_reads();
+unsigned long host_io_writes();
+
+/**
+ * system clock cycles charged for io since the last reset
+ *
+ */
+unsigned long long host_io_cycles();
+
+/**
+ * clear the io access counters
+ *
+ */
+void host_io_reset_count();
+
+extern "C" {
+#endif
+
+/**
+ * read an io register (byte address)
+ *
+ */
+uint32_t host_io_read(uint32_t addr);
+
+/**
+ * write an io register (byte address)
+ *
+ */
+void host_io_write(uint32_t addr, uint32_t data);
+
+/**
+ * the program idles for us microseconds
+ *
+ * @param us idle time
+ * @note virtual clock: time moves ahead by us; wall clock: no effect
+ *
+ */
+void host_io_idle(uint64_t us);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif  // _HOST_IO_H_INCLUDED
@@ -0,0 +1,73 @@
+/*****************************************************************//**
+ * @file mix_bench.cpp
+ *
+ * @brief host cost per sample of the software mixer
+ *
+ * Usage:
+ *    mix_bench
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost
+ *          Host/mix_bench.cpp Host/host_io.cpp Host/video_model.cpp
+ *          Driver/mixer.cpp Driver/gpio_cores.cpp Driver/ddfs_core.cpp
+ *          Driver/chu_init.cpp Driver/timer_core.cpp
+ *          Driver/uart_core.cpp -o mix_bench
+ *  - times Mixer::mix() with 0 to N_VOICES sounding voices and prints
+ *    one tab-separated line each: # voices, host ns per sample,
+ *    host cpu cycles per sample (x86 time stamp counter; 0 elsewhere)
+ *  - mix() does no io, so the host figures are the cost of the
+ *    algorithm itself; the board budget is 625 clocks per sample
+ *    at 16 kHz (see mixer.h); scale by the host/MCS speed ratio or
+ *    compare the per-voice step between commits
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <chrono>
+#include "host_io.h"
+#include "mixer.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum {
+   N_SAMPLES = 4000000
+};
+
+static uint64_t cpu_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+   return (__rdtsc());
+#else
+   return (0);
+#endif
+}
+
+int main() {
+   static const int NOTES[Mixer::N_VOICES] = { 60, 64, 67, 72 };
+   std::chrono::steady_clock::time_point t0;
+   PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+   Mixer mix(&pwm, Mixer::DEF_CH);
+   volatile int sink = 0;
+   uint64_t c0, cyc;
+   double ns;
+   int v, i;
+
+   mix.init();
+   printf("voices\thost_ns\thost_cycles\n");
+   for (v = 0; v <= Mixer::N_VOICES; v++) {
+      for (i = 0; i < Mixer::N_VOICES; i++) {
+         if (i < v)
+            mix.note_on(i, NOTES[i], i % Mixer::N_WAVES, 200, Mixer::HOLD);
+         else
+            mix.note_off(i);
+      }
+      t0 = std::chrono::steady_clock::now();
+      c0 = cpu_cycles();
+      for (i = 0; i < N_SAMPLES; i++)
+         sink = sink + mix.mix();
+      cyc = cpu_cycles() - c0;
+      ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+      printf("%d\t%.2f\t%.1f\n", v, ns / N_SAMPLES, (double) cyc / N_SAMPLES);
+   }
+   return (0);
+}
@@ -0,0 +1,140 @@
+/*****************************************************************//**
+ * @file pcm_rx.cpp
+ *
+ * @brief host-side receiver for PcmCapture frames; writes a WAV file
+ *
+ * Usage:
+ *    pcm_rx <serial device or capture file> <out.wav> [seconds]
+ *
+ *  - the serial port must be configured beforehand
+ *    (e.g., stty -F /dev/ttyUSB1 230400 raw)
+ *  - frames with a bad checksum are replaced by silence
+ *  - "dropped" counts (inserted before their block) and lost frames
+ *    (seq gaps) are filled with silence so the timing of the
+ *    recording is preserved
+ *  - recording stops after the given # seconds or at end of input
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+// frame layout must match Driver/pcm_capture.h
+enum {
+   SYNC0 = 0xa5,
+   SYNC1 = 0x5a,
+   HDR_LEN = 8,
+   MAX_SAMPLES = 255
+};
+
+static void put16(FILE *f, uint16_t v) {
+   fputc(v & 0xff, f);
+   fputc(v >> 8, f);
+}
+
+static void put32(FILE *f, uint32_t v) {
+   put16(f, (uint16_t) v);
+   put16(f, (uint16_t) (v >> 16));
+}
+
+// 16-bit mono pcm WAV header; sizes patched when done
+static void wav_header(FILE *f, uint32_t rate, uint32_t n_samples) {
+   fseek(f, 0, SEEK_SET);
+   fwrite("RIFF", 1, 4, f);
+   put32(f, 36 + 2 * n_samples);
+   fwrite("WAVEfmt ", 1, 8, f);
+   put32(f, 16);        // fmt chunk size
+   put16(f, 1);         // pcm
+   put16(f, 1);         // mono
+   put32(f, rate);
+   put32(f, 2 * rate);  // byte rate
+   put16(f, 2);         // block align
+   put16(f, 16);        // bits per sample
+   fwrite("data", 1, 4, f);
+   put32(f, 2 * n_samples);
+}
+
+static void silence(FILE *f, uint32_t n, uint32_t *total) {
+   for (uint32_t i = 0; i < n; i++)
+      put16(f, 0);
+   *total += n;
+}
+
+// read exactly n bytes; return 0 at end of input
+static int read_n(FILE *f, uint8_t *buf, int n) {
+   return (fread(buf, 1, n, f) == (size_t) n);
+}
+
+int main(int argc, char *argv[]) {
+   FILE *in, *out;
+   uint8_t hdr[HDR_LEN], payload[2 * MAX_SAMPLES], chk;
+   uint32_t rate = 0, total = 0, limit = 0, frames = 0, bad = 0;
+   int c, prev = -1, n, i;
+
+   if (argc < 3) {
+      fprintf(stderr, "usage: %s <input> <out.wav> [seconds]\n", argv[0]);
+      return (1);
+   }
+   in = fopen(argv[1], "rb");
+   out = fopen(argv[2], "wb");
+   if (!in || !out) {
+      fprintf(stderr, "cannot open input/output\n");
+      return (1);
+   }
+   if (argc > 3)
+      limit = (uint32_t) atoi(argv[3]);
+   wav_header(out, 8000, 0);
+   while (1) {
+      // hunt for sync pattern; a byte that breaks a pattern may
+      // start the next one (e.g., a5 a5 5a)
+      c = fgetc(in);
+      while (c != EOF) {
+         if (c != SYNC0) {
+            c = fgetc(in);
+            continue;
+         }
+         c = fgetc(in);
+         if (c == SYNC1)
+            break;
+      }
+      if (c == EOF)
+         break;
+      hdr[0] = SYNC0;
+      hdr[1] = SYNC1;
+      if (!read_n(in, hdr + 2, HDR_LEN - 2))
+         break;
+      n = hdr[3];
+      if (!read_n(in, payload, 2 * n) || !read_n(in, &chk, 1))
+         break;
+      if (rate == 0)
+         rate = hdr[4] | (hdr[5] << 8);
+      // verify checksum
+      uint8_t sum = chk;
+      for (i = 2; i < HDR_LEN; i++)
+         sum += hdr[i];
+      for (i = 0; i < 2 * n; i++)
+         sum += payload[i];
+      // lost frames
+      if (prev >= 0 && hdr[2] != (uint8_t) (prev + 1))
+         silence(out, (uint32_t) ((uint8_t) (hdr[2] - prev - 1)) * n, &total);
+      prev = hdr[2];
+      silence(out, hdr[6] | (hdr[7] << 8), &total);
+      if (sum != 0) {
+         bad++;
+         silence(out, n, &total);
+      } else {
+         fwrite(payload, 1, 2 * n, out);   // already 16-bit little endian
+         total += n;
+      }
+      frames++;
+      if (limit && rate && total >= limit * rate)
+         break;
+   }
+   wav_header(out, rate ? rate : 8000, total);
+   fclose(out);
+   fclose(in);
+   printf("%u frames (%u bad), %u samples at %u Hz\n", frames, bad, total, rate);
+   return (0);
+}
@@ -0,0 +1,97 @@
+/*****************************************************************//**
+ * @file replay_check.cpp
+ *
+ * @brief check the time stamps of the ReplayLog records
+ *
+ * Usage:
+ *    replay_check
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost -IApplication
+ *          Host/replay_check.cpp Host/host_io.cpp Host/video_model.cpp
+ *          Application/replay.cpp Driver/chu_init.cpp
+ *          Driver/timer_core.cpp Driver/uart_core.cpp -o replay_check
+ *  - runs on the virtual clock of the host timer model
+ *  - cases:
+ *      stale: an input event seen before an ai record but consumed
+ *             after it (update_menu() keeps presses queued while the
+ *             typewriter runs) must cost one word and replay in order
+ *      gap  : a delta beyond MAX_DT must be split into REC_TIME words
+ *             and replay at the recorded time
+ *  - prints one line per case; exit code 1 on any failure
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include "host_io.h"
+#include "chu_init.h"
+#include "input.h"
+#include "replay.h"
+
+static ReplayLog rlog;
+
+static InputEvent key_event(unsigned long ms, int code) {
+   InputEvent ev;
+
+   ev.ms = (uint32_t) ms;
+   ev.type = InputService::EV_KEY;
+   ev.code = (uint8_t) code;
+   ev.value = 1;
+   return (ev);
+}
+
+/* replay the log; check the ai depth, then the key and its time */
+static int replay_ok(int depth, int code, unsigned long *ms) {
+   InputEvent ev;
+
+   rlog.start_replay();
+   if (rlog.get_ai() != depth)
+      return (0);
+   if (!rlog.get_input(&ev) || ev.code != code)
+      return (0);
+   *ms = ev.ms;
+   return (1);
+}
+
+static int check_stale() {
+   unsigned long seen, ms;
+   int ok;
+
+   rlog.start_record(1);
+   sleep_ms(20);
+   seen = now_ms();
+   sleep_ms(300);
+   rlog.put_ai(3);
+   rlog.put_input(key_event(seen, 'a'));
+   ok = !rlog.overflow() && rlog.words() == 4 && replay_ok(3, 'a', &ms);
+   printf("stale: %d words, overflow %d: %s\n", rlog.words(), rlog.overflow(),
+          ok ? "ok" : "FAIL");
+   return (ok);
+}
+
+static int check_gap() {
+   const unsigned long GAP_MS = 2 * ReplayLog::MAX_DT + 500;
+   unsigned long t0, ms;
+   int ok;
+
+   rlog.start_record(2);
+   rlog.put_ai(1);
+   sleep_ms(GAP_MS);
+   rlog.put_input(key_event(now_ms(), 'b'));
+   // replayed times count from start_replay()
+   t0 = now_ms();
+   ok = !rlog.overflow() && rlog.words() == 6 && replay_ok(1, 'b', &ms)
+         && ms - t0 >= GAP_MS && ms - t0 <= GAP_MS + 1;
+   printf("gap  : %d words, overflow %d: %s\n", rlog.words(), rlog.overflow(),
+          ok ? "ok" : "FAIL");
+   return (ok);
+}
+
+int main() {
+   int bad = 0;
+
+   host_io_virtual_clock(1);
+   bad = bad + !check_stale();
+   bad = bad + !check_gap();
+   return (bad > 0);
+}
@@ -0,0 +1,80 @@
+/*****************************************************************//**
+ * @file tap_replay.cpp
+ *
+ * @brief feed a recorded accelerometer trace through TapDetector
+ *        and list the detected taps
+ *
+ * Usage:
+ *    tap_replay <trace file | -> [rate on_thr off_thr debounce refract_ms]
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost -IApplication
+ *          Host/tap_replay.cpp Application/tap_detect.cpp
+ *          Driver/spi_core.cpp Driver/chu_init.cpp Driver/timer_core.cpp
+ *          Driver/uart_core.cpp Host/host_io.cpp Host/video_model.cpp
+ *          -o tap_replay
+ *  - trace: one sample per line, raw 8-bit x y z readings (signed,
+ *    64 LSB per g) separated by blanks or commas; lines starting
+ *    with "#" are ignored; "-" reads stdin
+ *  - the optional parameters override the TapDetector defaults
+ *    (sample rate in Hz, levels in LSB, # samples, ms)
+ *  - prints one line per tap: sample #, time in ms, magnitude in
+ *    LSB; then the # samples, # taps and peak magnitude
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "tap_detect.h"
+
+int main(int argc, char *argv[]) {
+   TapDetector tap(0);    // process() only; no spi access
+   FILE *f;
+   char line[256];
+   int x, y, z, rate, taps = 0;
+   long n = 0;
+   int32_t peak = 0;
+
+   if (argc < 2) {
+      fprintf(stderr, "usage: %s <trace | -> [rate on_thr off_thr debounce refract_ms]\n", argv[0]);
+      return (1);
+   }
+   f = (strcmp(argv[1], "-") == 0) ? stdin : fopen(argv[1], "r");
+   if (!f) {
+      fprintf(stderr, "cannot read %s\n", argv[1]);
+      return (1);
+   }
+   rate = (argc > 2) ? atoi(argv[2]) : (int) TapDetector::DEF_RATE;
+   if (rate <= 0) {
+      fprintf(stderr, "bad sample rate %s\n", argv[2]);
+      return (1);
+   }
+   tap.set_rate(rate);
+   if (argc > 4)
+      tap.set_threshold(atoi(argv[3]), atoi(argv[4]));
+   if (argc > 6)
+      tap.set_timing(atoi(argv[5]), atoi(argv[6]));
+   tap.reset();
+   printf("sample\tms\tmagnitude\n");
+   while (fgets(line, sizeof(line), f)) {
+      if (line[0] == '#')
+         continue;
+      for (char *p = line; *p; p++)
+         if (*p == ',')
+            *p = ' ';
+      if (sscanf(line, "%d %d %d", &x, &y, &z) != 3)
+         continue;
+      if (tap.process((int8_t) x, (int8_t) y, (int8_t) z)) {
+         printf("%ld\t%ld\t%.2f\n", n, n * 1000 / rate, tap.magnitude() / 256.0);
+         taps++;
+      }
+      if (tap.magnitude() > peak)
+         peak = tap.magnitude();
+      n++;
+   }
+   if (f != stdin)
+      fclose(f);
+   printf("# samples %ld  taps %d  peak magnitude %.2f\n", n, taps, peak / 256.0);
+   return (0);
+}
@@ -0,0 +1,92 @@
+/*****************************************************************//**
+ * @file video_dump.cpp
+ *
+ * @brief draw a test scene through the video drivers on the host and
+ *        save the composited frames as PPM images
+ *
+ * Usage:
+ *    video_dump <HDL directory> <out prefix>
+ *
+ *  - build:
+ *      g++ -O2 -include Host/host_io.h -IDriver -IHost
+ *          Host/video_dump.cpp Host/video_model.cpp Host/host_io.cpp
+ *          Driver/vga_core.cpp -o video_dump
+ *  - the drivers run unchanged; their io writes go to VideoModel
+ *  - writes <prefix>_0.ppm (reset values, before any core exists),
+ *    <prefix>_1.ppm (scene), <prefix>_2.ppm (bar and gray on),
+ *    <prefix>_3.ppm (everything bypassed)
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include "host_io.h"
+#include "video_model.h"
+#include "vga_core.h"
+
+static VideoModel model;
+
+static int dump(const char *prefix, int n) {
+   char path[512];
+
+   snprintf(path, sizeof(path), "%s_%d.ppm", prefix, n);
+   if (!model.write_ppm(path)) {
+      fprintf(stderr, "cannot write %s\n", path);
+      return (0);
+   }
+   printf("%s\n", path);
+   return (1);
+}
+
+// the cores write their reset settings in the constructors, so they
+// are created after the model is attached
+static int scene(const char *prefix) {
+   FrameCore frame(FRAME_BASE);
+   GpvCore bar(get_sprite_addr(BRIDGE_BASE, V7_BAR));
+   GpvCore gray(get_sprite_addr(BRIDGE_BASE, V6_GRAY));
+   SpriteCore cursor(get_sprite_addr(BRIDGE_BASE, V4_USER4), 1024);
+   SpriteCore mewtwo(get_sprite_addr(BRIDGE_BASE, V3_GHOST), 16384);
+   OsdCore osd(get_sprite_addr(BRIDGE_BASE, V2_OSD));
+   SpriteCore snorlax(get_sprite_addr(BRIDGE_BASE, V1_MOUSE), 16384);
+   const char *msg = "video model test";
+   int i;
+
+   frame.clr_screen(0x1ff);
+   frame.fillRoundRect(40, 300, 300, 120, 40, 0x092);
+   frame.fillCircle(480, 140, 60, 0x1c0);
+   frame.plot_line(0, 0, 639, 479, 0x007);
+   for (i = 0; msg[i] != 0; i++)
+      osd.wr_char(5 + i, 24, msg[i]);
+   osd.wr_char(5, 26, 'R', 1);
+   snorlax.move_xy(60, 180);
+   mewtwo.move_xy(420, 60);
+   cursor.move_xy(300, 300);
+   if (!dump(prefix, 1))
+      return (0);
+   bar.bypass(0);
+   gray.bypass(0);
+   if (!dump(prefix, 2))
+      return (0);
+   frame.bypass(1);
+   bar.bypass(1);
+   gray.bypass(1);
+   osd.bypass(1);
+   snorlax.bypass(1);
+   mewtwo.bypass(1);
+   cursor.bypass(1);
+   if (!dump(prefix, 3))
+      return (0);
+   return (1);
+}
+
+int main(int argc, char *argv[]) {
+   if (argc < 3) {
+      fprintf(stderr, "usage: %s <HDL directory> <out prefix>\n", argv[0]);
+      return (1);
+   }
+   host_io_attach_video(&model);
+   if (model.load_mem(argv[1]) != 4)
+      fprintf(stderr, "warning: some .mem files not found in %s\n", argv[1]);
+   if (!dump(argv[2], 0) || !scene(argv[2]))
+      return (1);
+   return (0);
+}
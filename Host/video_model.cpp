@@ -0,0 +1,271 @@
+/*****************************************************************//**
+ * @file video_model.cpp
+ *
+ * @brief implementation of VideoModel class
+ *
+ ********************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include "video_model.h"
+#include "chu_io_map.h"
+
+// sprite stage of each video slot (-1: not a sprite)
+static const int SLOT_SPRITE[8] = {
+   -1, VideoModel::SP_MOUSE, -1, VideoModel::SP_GHOST,
+   VideoModel::SP_CURSOR, -1, -1, -1
+};
+
+/*
+ * read a $readmemb file: one binary word per token, "//" comments
+ * and blank lines ignored; returns # words read
+ */
+static int read_memb(const char *path, uint8_t *dst, int max) {
+   FILE *f;
+   int c, n = 0, v = 0, digits = 0, comment = 0;
+
+   f = fopen(path, "r");
+   if (!f)
+      return (-1);
+   while ((c = fgetc(f)) != EOF) {
+      if (comment) {
+         comment = (c != '\n');
+         continue;
+      }
+      if (c == '0' || c == '1') {
+         v = (v << 1) | (c - '0');
+         digits++;
+         continue;
+      }
+      if (digits > 0 && n < max)
+         dst[n++] = (uint8_t) v;
+      v = digits = 0;
+      if (c == '/')
+         comment = 1;
+   }
+   if (digits > 0 && n < max)
+      dst[n++] = (uint8_t) v;
+   fclose(f);
+   return (n);
+}
+
+VideoModel::VideoModel() {
+   memset(frame, 0, sizeof(frame));
+   memset(tile, 0, sizeof(tile));
+   memset(font, 0, sizeof(font));
+   memset(bits, 0, sizeof(bits));
+   sp_size[SP_MOUSE] = sp_size[SP_GHOST] = SPRITE_SIZE;
+   sp_size[SP_CURSOR] = CURSOR_SIZE;
+   sp_color[SP_MOUSE] = 0x022;
+   sp_color[SP_GHOST] = 0x202;
+   sp_color[SP_CURSOR] = 0x111;
+   for (int s = 0; s < N_SPRITES; s++) {
+      sp_x0[s] = sp_y0[s] = 0;
+      sp_bypass[s] = 0;
+   }
+   frame_bypass = 0;
+   bar_bypass = 1;
+   gray_bypass = 1;
+   osd_bypass = 0;
+   osd_fg = 0xfff;
+   osd_bg = 0x000;
+}
+
+VideoModel::~VideoModel() {
+}  // not used
+
+int VideoModel::load_mem(const char *hdl_dir) {
+   static const char *const SPRITE_FILE[N_SPRITES] = {
+      "snorlax.mem", "mewtwo.mem", "cursor.mem"
+   };
+   char path[512];
+   int s, sz, n = 0;
+
+   snprintf(path, sizeof(path), "%s/font.mem", hdl_dir);
+   if (read_memb(path, font, FONT_ROWS) > 0)
+      n++;
+   for (s = 0; s < N_SPRITES; s++) {
+      sz = sp_size[s];
+      snprintf(path, sizeof(path), "%s/%s", hdl_dir, SPRITE_FILE[s]);
+      if (read_memb(path, bits[s], sz * sz) > 0)
+         n++;
+   }
+   return (n);
+}
+
+void VideoModel::clear_frame() {
+   memset(frame, 0, sizeof(frame));
+}
+
+uint64_t VideoModel::frame_hash() {
+   uint64_t h = 0xcbf29ce484222325ull;
+
+   for (int i = 0; i < HMAX * VMAX; i++) {
+      h = (h ^ (frame[i] & 0xff)) * 0x100000001b3ull;
+      h = (h ^ (frame[i] >> 8)) * 0x100000001b3ull;
+   }
+   return (h);
+}
+
+// register map of chu_vga_sprite_*_core.sv / cursor_core.sv
+void VideoModel::write_sprite(int s, uint32_t reg, uint32_t data) {
+   int sz = sp_size[s];
+
+   if (!(reg & REG_BIT)) {
+      bits[s][reg & (sz * sz - 1)] = data & 1;
+      return;
+   }
+   switch (reg & 3) {
+   case 0:
+      sp_bypass[s] = data & 1;
+      break;
+   case 1:
+      sp_x0[s] = data & 0x7ff;
+      break;
+   case 2:
+      sp_y0[s] = data & 0x7ff;
+      break;
+   }
+}
+
+void VideoModel::write(uint32_t addr, uint32_t data) {
+   uint32_t reg;
+   int slot;
+
+   if (addr & FRAME_BIT) {
+      addr = addr & (FRAME_BIT - 1);
+      if (addr == FRAME_BYPASS)
+         frame_bypass = data & 1;
+      else if (addr < HMAX * VMAX)
+         frame[addr] = data & 0x1ff;
+      return;
+   }
+   slot = (addr >> 14) & 7;
+   reg = addr & 0x3fff;
+   if (SLOT_SPRITE[slot] >= 0) {
+      write_sprite(SLOT_SPRITE[slot], reg, data);
+      return;
+   }
+   switch (slot) {
+   case V2_OSD:
+      if (!(reg & REG_BIT))
+         tile[reg & (TILE_ROWS * TILE_COLS - 1)] = (uint8_t) data;
+      else if ((reg & 3) == 0)
+         osd_bypass = data & 1;
+      else if ((reg & 3) == 1)
+         osd_fg = data & 0xfff;
+      else if ((reg & 3) == 2)
+         osd_bg = data & 0xfff;
+      break;
+   case V6_GRAY:
+      gray_bypass = data & 1;   // any address
+      break;
+   case V7_BAR:
+      bar_bypass = data & 1;    // any address
+      break;
+   default:
+      break;                    // sync and dummy cores: no state
+   }
+}
+
+// three outlined boxes on white (bar_src.sv)
+uint16_t VideoModel::bar_pixel(int x, int y) {
+   if (((y == 40 || y == 120) && x >= 3 && x <= 240) ||
+       ((x == 3 || x == 240) && y >= 40 && y <= 120))
+      return (0x000);
+   if (((y == 240 || y == 380) && x >= 400) ||
+       (x == 400 && y >= 240 && y <= 380))
+      return (0x000);
+   if (y == 380 || (x == 0 && y >= 380))
+      return (0x000);
+   return (0xfff);
+}
+
+uint16_t VideoModel::osd_pixel(int x, int y) {
+   uint8_t ch, word;
+   int on;
+
+   ch = tile[((y >> 4) << 7) | (x >> 3)];
+   if ((ch & 0x7f) == 0)
+      return (KEY_COLOR);
+   word = font[((ch & 0x7f) << 4) | (y & 15)];
+   on = (word >> (7 - (x & 7))) & 1;
+   if (ch & 0x80)
+      on = !on;   // reversed tile swaps fg and bg
+   return (on ? osd_fg : osd_bg);
+}
+
+uint16_t VideoModel::sprite_pixel(int s, int x, int y) {
+   int xr = x - sp_x0[s];
+   int yr = y - sp_y0[s];
+   int sz = sp_size[s];
+
+   if (xr < 0 || xr >= sz || yr < 0 || yr >= sz)
+      return (KEY_COLOR);
+   return (bits[s][yr * sz + xr] ? sp_color[s] : 0x000);
+}
+
+void VideoModel::render(uint16_t *rgb) {
+   static const int BELOW_OSD[2] = { SP_CURSOR, SP_GHOST };
+   uint16_t c, p, r, g, b, gray;
+   uint32_t f;
+   int x, y, i;
+
+   for (y = 0; y < VMAX; y++) {
+      for (x = 0; x < HMAX; x++) {
+         // frame buffer through frame_palette_9
+         if (frame_bypass) {
+            c = FRAME_BG;
+         } else {
+            f = frame[y * HMAX + x];
+            r = (f >> 6) & 7;
+            g = (f >> 3) & 7;
+            b = f & 7;
+            c = ((r << 1 | r >> 2) << 8) | ((g << 1 | g >> 2) << 4) | (b << 1 | b >> 2);
+         }
+         if (!bar_bypass)
+            c = bar_pixel(x, y);
+         if (!gray_bypass) {
+            gray = ((c >> 8) * 0x35 + ((c >> 4) & 15) * 0xb8 + (c & 15) * 0x12) >> 8;
+            c = (gray << 8) | (gray << 4) | gray;
+         }
+         for (i = 0; i < 2; i++) {
+            if (sp_bypass[BELOW_OSD[i]])
+               continue;
+            p = sprite_pixel(BELOW_OSD[i], x, y);
+            if (p != KEY_COLOR)
+               c = p;
+         }
+         if (!osd_bypass) {
+            p = osd_pixel(x, y);
+            if (p != KEY_COLOR)
+               c = p;
+         }
+         if (!sp_bypass[SP_MOUSE]) {
+            p = sprite_pixel(SP_MOUSE, x, y);
+            if (p != KEY_COLOR)
+               c = p;
+         }
+         rgb[y * HMAX + x] = c;
+      }
+   }
+}
+
+int VideoModel::write_ppm(const char *path) {
+   static uint16_t rgb[HMAX * VMAX];
+   FILE *f;
+   int i;
+
+   f = fopen(path, "wb");
+   if (!f)
+      return (0);
+   render(rgb);
+   fprintf(f, "P6\n%d %d\n255\n", (int) HMAX, (int) VMAX);
+   for (i = 0; i < HMAX * VMAX; i++) {
+      fputc(((rgb[i] >> 8) & 15) * 17, f);
+      fputc(((rgb[i] >> 4) & 15) * 17, f);
+      fputc((rgb[i] & 15) * 17, f);
+   }
+   fclose(f);
+   return (1);
+}
@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * @file video_model.h
+ *
+ * @brief host reference model of the video daisy chain
+ *
+ * Description:
+ *  - cycle-agnostic model of video_sys_daisy.sv: takes the same
+ *    register/memory writes as the hardware and composites a whole
+ *    640x480 frame on request
+ *  - chain (first to last stage):
+ *      frame buffer -> V7 bar -> V6 gray -> V5 dummy -> V4 cursor
+ *      -> V3 ghost -> V2 osd -> V1 mouse -> screen
+ *  - each stage either passes its input through (bypass) or
+ *    overlays its own pixel; chroma key 0 is transparent for the
+ *    osd and the sprites
+ *  - frame buffer: 9-bit pixels expanded by frame_palette_9
+ *  - osd: 8x16 tiles (80x30 on screen) rendered with font.mem
+ *  - sprites: 1-bit bitmaps (snorlax.mem, mewtwo.mem, cursor.mem)
+ *    with one color each
+ *  - reset values follow the HDL: bar and gray bypassed, all other
+ *    stages enabled, osd white on black
+ *  - colors are 12-bit rgb (4 bits per channel)
+ *
+ *********************************************************************/
+
+#ifndef _VIDEO_MODEL_H_INCLUDED
+#define _VIDEO_MODEL_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * video chain model
+ *
+ */
+class VideoModel {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      HMAX = 640,                 /**< pixels per row */
+      VMAX = 480,                 /**< rows per frame */
+      KEY_COLOR = 0,              /**< chroma key */
+      FRAME_BIT = 1 << 20,        /**< word address: frame buffer */
+      FRAME_BYPASS = 0xfffff,     /**< frame buffer bypass register */
+      FRAME_BG = 0x008,           /**< color ahead of the frame buffer */
+      REG_BIT = 1 << 13,          /**< core address: register */
+      TILE_COLS = 128,            /**< tile ram: 7-bit column */
+      TILE_ROWS = 32,             /**< tile ram: 5-bit row */
+      FONT_ROWS = 128 * 16,       /**< 128 chars, 16 rows each */
+      SPRITE_SIZE = 128,          /**< mouse/ghost bitmap size */
+      CURSOR_SIZE = 32            /**< cursor bitmap size */
+   };
+   /**
+    * sprite stages
+    *
+    */
+   enum {
+      SP_MOUSE = 0,
+      SP_GHOST,
+      SP_CURSOR,
+      N_SPRITES
+   };
+
+   /**
+    * constructor (all memories cleared, registers at reset values)
+    *
+    */
+   VideoModel();
+   ~VideoModel();  // not used
+
+   /**
+    * load the ROM/RAM initial contents
+    *
+    * @param hdl_dir directory of font.mem and the sprite .mem files
+    * @return # files loaded (4 when all found)
+    *
+    */
+   int load_mem(const char *hdl_dir);
+
+   /**
+    * write a word into the video address space
+    *
+    * @param addr word address (bit 20: frame buffer; else slot in
+    *        bits 16-14 and core address in bits 13-0)
+    * @param data 32-bit data
+    *
+    */
+   void write(uint32_t addr, uint32_t data);
+
+   /**
+    * clear the frame buffer ram (as if all pixels were written 0)
+    *
+    */
+   void clear_frame();
+
+   /**
+    * 64-bit FNV-1a hash of the frame buffer ram
+    *
+    * @return hash (same pixels give the same value on any host)
+    *
+    */
+   uint64_t frame_hash();
+
+   /**
+    * composite the current frame
+    *
+    * @param rgb 12-bit pixels, row-major HMAX x VMAX
+    *
+    */
+   void render(uint16_t *rgb);
+
+   /**
+    * composite the current frame and save it as a binary PPM
+    *
+    * @param path output file
+    * @return 1: written; 0: could not open the file
+    *
+    */
+   int write_ppm(const char *path);
+
+private:
+   uint16_t frame[HMAX * VMAX];     // 9-bit pixels
+   uint8_t tile[TILE_ROWS * TILE_COLS];
+   uint8_t font[FONT_ROWS];
+   uint8_t bits[N_SPRITES][SPRITE_SIZE * SPRITE_SIZE];
+   int sp_size[N_SPRITES];
+   uint16_t sp_color[N_SPRITES];
+   int sp_x0[N_SPRITES], sp_y0[N_SPRITES];
+   int sp_bypass[N_SPRITES];
+   int frame_bypass, bar_bypass, gray_bypass, osd_bypass;
+   uint16_t osd_fg, osd_bg;
+   /* methods */
+   void write_sprite(int s, uint32_t reg, uint32_t data);
+   uint16_t bar_pixel(int x, int y);
+   uint16_t osd_pixel(int x, int y);
+   uint16_t sprite_pixel(int s, int x, int y);
+};
+
+#endif  // _VIDEO_MODEL_H_INCLUDED